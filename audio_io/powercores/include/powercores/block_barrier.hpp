@@ -0,0 +1,31 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace powercores {
+
+/**A reusable barrier for one waiting thread and a known number of arriving threads.
+
+Call arm with the number of arrivals to expect, hand work to that many threads which each call arrive when they finish, and call wait.
+wait spins for a while before sleeping, so short batches never touch the kernel.
+Nothing allocates after construction, so this can be rearmed every audio block.
+
+arm must not be called while a previous batch is still in flight.*/
+class BlockBarrier {
+	public:
+	BlockBarrier(int spinIterations = 4000);
+	void arm(int count);
+	void arrive();
+	void wait();
+	void setSpinIterations(int iterations);
+	private:
+	std::atomic<int> remaining{0}, waiter_sleeping{0};
+	int spin_iterations;
+	std::mutex mutex;
+	std::condition_variable condvar;
+};
+
+}
@@ -0,0 +1,138 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <stdint.h>
+#include "utilities.hpp"
+
+namespace powercores {
+
+namespace bounded_queues_detail {
+//Queue capacities are rounded up to powers of two so that we can mask instead of dividing.
+inline size_t roundUpToPowerOfTwo(size_t n) {
+	size_t ret = 1;
+	while(ret < n) ret *= 2;
+	return ret;
+}
+}
+
+/**A lock-free bounded queue for exactly one producer thread and exactly one consumer thread.
+
+Neither enqueue nor dequeue ever allocate or block; they fail instead.
+T must be default constructible and copy assignable.*/
+template <typename T>
+class SpscQueue: public CacheLineAligned {
+	public:
+	SpscQueue(size_t capacity): capacity(bounded_queues_detail::roundUpToPowerOfTwo(capacity)), mask(this->capacity-1), buffer(new T[this->capacity]) {}
+
+	/**Producer only. Returns false if the queue is full.*/
+	bool enqueue(const T &item) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		if(t-head_cache == capacity) {
+			head_cache = head.load(std::memory_order_acquire);
+			if(t-head_cache == capacity) return false;
+		}
+		buffer[t&mask] = item;
+		tail.store(t+1, std::memory_order_release);
+		return true;
+	}
+
+	/**Consumer only. Returns false if the queue is empty.*/
+	bool dequeue(T &out) {
+		size_t h = head.load(std::memory_order_relaxed);
+		if(h == tail_cache) {
+			tail_cache = tail.load(std::memory_order_acquire);
+			if(h == tail_cache) return false;
+		}
+		out = buffer[h&mask];
+		head.store(h+1, std::memory_order_release);
+		return true;
+	}
+
+	/**Approximate unless called from the consumer.*/
+	bool empty() {
+		return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+	}
+
+	size_t getCapacity() {
+		return capacity;
+	}
+
+	private:
+	size_t capacity, mask;
+	std::unique_ptr<T[]> buffer;
+	//The producer and consumer each get a cache line.
+	alignas(64) std::atomic<size_t> tail{0};
+	size_t head_cache = 0; //producer's view of head.
+	alignas(64) std::atomic<size_t> head{0};
+	size_t tail_cache = 0; //consumer's view of tail.
+};
+
+/**A lock-free bounded queue for any number of producers and consumers.
+
+This is Dmitry Vyukov's array-based queue: every cell carries a sequence number saying whose turn it is, so producers and consumers only contend on their respective counters.
+As with SpscQueue, nothing here allocates or blocks after construction.
+T must be default constructible and copy assignable.*/
+template <typename T>
+class MpmcQueue: public CacheLineAligned {
+	public:
+	MpmcQueue(size_t capacity): capacity(bounded_queues_detail::roundUpToPowerOfTwo(capacity)), mask(this->capacity-1), cells(new Cell[this->capacity]) {
+		for(size_t i = 0; i < this->capacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	/**Returns false if the queue is full.*/
+	bool enqueue(const T &item) {
+		Cell* cell;
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		while(true) {
+			cell = &cells[pos&mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq-(intptr_t)pos;
+			if(diff == 0) {
+				if(enqueue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) break;
+			}
+			else if(diff < 0) return false;
+			else pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+		cell->data = item;
+		cell->sequence.store(pos+1, std::memory_order_release);
+		return true;
+	}
+
+	/**Returns false if the queue is empty.*/
+	bool dequeue(T &out) {
+		Cell* cell;
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		while(true) {
+			cell = &cells[pos&mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq-(intptr_t)(pos+1);
+			if(diff == 0) {
+				if(dequeue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) break;
+			}
+			else if(diff < 0) return false;
+			else pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+		out = cell->data;
+		cell->sequence.store(pos+mask+1, std::memory_order_release);
+		return true;
+	}
+
+	size_t getCapacity() {
+		return capacity;
+	}
+
+	private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+	size_t capacity, mask;
+	std::unique_ptr<Cell[]> cells;
+	alignas(64) std::atomic<size_t> enqueue_pos{0};
+	alignas(64) std::atomic<size_t> dequeue_pos{0};
+};
+
+}
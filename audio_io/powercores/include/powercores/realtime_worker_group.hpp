@@ -0,0 +1,80 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include "bounded_queues.hpp"
+#include "block_barrier.hpp"
+#include "utilities.hpp"
+
+namespace powercores {
+
+/**A group of threads for running short, latency-sensitive batches of work, e.g. one per audio block.
+
+ThreadPool is general purpose: every job is a std::function in a mutex-protected queue, and waiting on a batch means a barrier and a future, all of which allocate.
+This class is for the opposite case.  The calling thread hands each worker a plain function pointer and context through a lock-free single-producer mailbox, participates itself, and then waits on a BlockBarrier.
+Workers spin for a while before sleeping, so back-to-back batches don't go through the kernel at all.
+Nothing allocates after start.
+
+run must only be called by one thread at a time.*/
+class RealtimeWorkerGroup {
+	public:
+	RealtimeWorkerGroup(int threadCount = 0, int spinIterations = 20000);
+	~RealtimeWorkerGroup();
+	void start();
+	void stop();
+	void setThreadCount(int n);
+	int getThreadCount();
+	bool isRunning();
+	/**How many times to spin waiting for work or for a batch to finish before sleeping.*/
+	void setSpinIterations(int iterations);
+	/**Called once on each worker thread as it starts, i.e. to raise thread priority.
+	Takes effect on the next start.*/
+	void setThreadStartCallback(std::function<void(void)> callback);
+
+	/**Call callable(i) for every i in [0, count), where 0 runs on the calling thread and the rest run on workers.
+	Returns when all of them have finished.
+	count may be at most one more than the thread count.
+	callable is used by reference, not copied.*/
+	template<typename CallableT>
+	void run(int count, CallableT &&callable) {
+		typedef typename std::remove_reference<CallableT>::type CallableType;
+		dispatch(count, [] (void* context, int index) {
+			(*(CallableType*)context)(index);
+		}, (void*)&callable);
+		callable(0);
+		completion.wait();
+	}
+
+	private:
+	struct Task {
+		void (*func)(void*, int) = nullptr;
+		void* context = nullptr;
+		int index = 0;
+	};
+	//The mailbox's counters are on their own cache lines, so workers must be too.
+	struct Worker: public CacheLineAligned {
+		Worker(): mailbox(4) {}
+		SpscQueue<Task> mailbox;
+		std::atomic<int> sleeping{0};
+		std::mutex mutex;
+		std::condition_variable condvar;
+		std::thread thread;
+	};
+	void dispatch(int count, void (*func)(void*, int), void* context);
+	void post(Worker &worker, Task task);
+	void workerThreadFunction(int id);
+	int thread_count, spin_iterations;
+	bool running = false;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::function<void(void)> thread_start_callback;
+	BlockBarrier completion;
+};
+
+}
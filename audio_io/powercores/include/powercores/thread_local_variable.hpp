@@ -7,6 +7,7 @@ See LICENSE in the root of the powercores repository for details.*/
 #include <system_error>
 #include <utility>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -5,9 +5,38 @@ See LICENSE in the root of the powercores repository for details.*/
 #include <system_error>
 #include <utility>
 #include <functional>
+#include <cstddef>
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 namespace powercores {
 
+/**Tell the CPU that we're in a spin loop.
+On x86 this is the pause instruction, which is much kinder to the other hyperthread than spinning flat out.  Elsewhere we just yield.*/
+inline void cpuRelax() {
+	#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+	_mm_pause();
+	#else
+	std::this_thread::yield();
+	#endif
+}
+
+/**Call from the body of a spin-wait loop with the number of times we've been around.
+The first few iterations use cpuRelax. After that we yield, so that we don't starve whatever we're waiting on if there are more threads than cores.*/
+inline void spinBackoff(int iteration) {
+	if(iteration < 64) cpuRelax();
+	else std::this_thread::yield();
+}
+
+/**Derive from this to make new and delete keep objects on cache line boundaries.
+Before C++17, new only promises the alignment of max_align_t, so an object with alignas(64) members can start mid-line and the padding that keeps its hot members apart does nothing.*/
+class CacheLineAligned {
+	public:
+	static void* operator new(std::size_t size);
+	static void operator delete(void* ptr);
+};
+
 /**If using threads directly, it is required that one deal with EAGAIN.
 This function wraps the std::thread constructor and automatically retries.
 If any other error besides EAGAIN (std::errc::resource_unavailable_try_again) occurs, the exception is rethrown.
@@ -0,0 +1,91 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+#pragma once
+#include <atomic>
+#include <memory>
+
+namespace powercores {
+
+/**A bounded work-stealing deque, after Chase and Lev.
+
+One thread owns the deque and may push and pop from the bottom.  Any number of other threads may steal from the top.
+The deque never wraps: the capacity is the maximum number of pushes between calls to reset.  This is intended for schedulers that know how many jobs a batch holds, and lets us avoid both allocation and the complexity of growing the buffer.
+
+reset is not threadsafe and must only be called when no other thread is using the deque.
+T must be trivially copyable.*/
+template <typename T>
+class WorkStealingDeque {
+	public:
+	WorkStealingDeque(int capacity = 0) {
+		reserve(capacity);
+	}
+
+	/**Make sure that the deque can hold at least capacity pushes.  Also resets.*/
+	void reserve(int capacity) {
+		if(capacity > this->capacity) {
+			buffer.reset(new std::atomic<T>[capacity]);
+			this->capacity = capacity;
+		}
+		reset();
+	}
+
+	void reset() {
+		top.store(0, std::memory_order_relaxed);
+		bottom.store(0, std::memory_order_relaxed);
+	}
+
+	int getCapacity() {
+		return capacity;
+	}
+
+	/**Owner only. Returns false if the deque is full.*/
+	bool push(T item) {
+		int b = bottom.load(std::memory_order_relaxed);
+		if(b >= capacity) return false;
+		buffer[b].store(item, std::memory_order_relaxed);
+		bottom.store(b+1, std::memory_order_release);
+		return true;
+	}
+
+	/**Owner only. Pops from the bottom. Returns false if the deque is empty.*/
+	bool pop(T &out) {
+		int b = bottom.load(std::memory_order_relaxed)-1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int t = top.load(std::memory_order_relaxed);
+		if(t > b) {
+			bottom.store(b+1, std::memory_order_relaxed);
+			return false;
+		}
+		out = buffer[b].load(std::memory_order_relaxed);
+		if(t == b) {
+			//Last item: race any thieves for it.
+			bool won = top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b+1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	/**Any thread. Steals from the top. Returns false if the deque was empty or if another thread won the race.*/
+	bool steal(T &out) {
+		int t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int b = bottom.load(std::memory_order_acquire);
+		if(t >= b) return false;
+		out = buffer[t].load(std::memory_order_relaxed);
+		return top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	/**Approximate; only useful as a hint.*/
+	bool empty() {
+		return top.load(std::memory_order_relaxed) >= bottom.load(std::memory_order_relaxed);
+	}
+
+	private:
+	std::unique_ptr<std::atomic<T>[]> buffer;
+	int capacity = 0;
+	std::atomic<int> top{0}, bottom{0};
+};
+
+}
@@ -0,0 +1,72 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+
+/**Compares the per-block cost of handing a small amount of work to a set of threads with ThreadPool and with RealtimeWorkerGroup.
+This mirrors what an audio planner does: every block, each thread processes some frames, and the caller must know when they're all done.
+
+Usage: bench_block_dispatch [threads] [blocks]*/
+#include <powercores/thread_pool.hpp>
+#include <powercores/realtime_worker_group.hpp>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+
+const int sr = 44100;
+
+//Something for the threads to do, sized in frames so that it scales like audio work.
+void work(std::vector<float> &buffer) {
+	for(int i = 0; i < buffer.size(); i++) buffer[i] = buffer[i]*0.999f+0.001f;
+}
+
+template<typename CallableT>
+double timeBlocks(int blocks, CallableT &&block) {
+	//Warm up, so that thread startup isn't counted.
+	for(int i = 0; i < 100; i++) block();
+	auto start = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < blocks; i++) block();
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::micro>(end-start).count()/blocks;
+}
+
+int main(int argc, char** args) {
+	int threads = argc > 1 ? atoi(args[1]) : 4;
+	int blocks = argc > 2 ? atoi(args[2]) : 20000;
+	if(threads < 2) {
+		printf("Need at least 2 threads.\n");
+		return 1;
+	}
+	printf("Dispatching to %i threads, %i blocks per measurement.\n", threads, blocks);
+	printf("%8s %14s %14s %14s\n", "frames", "period (us)", "pool (us)", "group (us)");
+	for(int frames = 64; frames <= 256; frames *= 2) {
+		std::vector<std::vector<float>> buffers(threads, std::vector<float>(frames, 0.0f));
+		double period = 1e6*frames/sr;
+		double poolTime, groupTime;
+		{
+			//This is how the planner used the pool: prime the threads, map over the work, barrier, and wait on a future.
+			powercores::ThreadPool pool{threads};
+			pool.start();
+			std::vector<int> indices(threads);
+			for(int i = 0; i < threads; i++) indices[i] = i;
+			poolTime = timeBlocks(blocks, [&] () {
+				pool.submitJobToAllThreads([] () {});
+				pool.map([&] (int i) {work(buffers[i]);}, indices.begin(), indices.end());
+				pool.submitBarrier();
+				auto future = pool.submitJobWithResult([] () {});
+				future.wait();
+			});
+		}
+		{
+			//The caller is one of the participants, so the group needs one less thread.
+			powercores::RealtimeWorkerGroup group{threads-1};
+			group.start();
+			auto callable = [&] (int i) {work(buffers[i]);};
+			groupTime = timeBlocks(blocks, [&] () {
+				group.run(threads, callable);
+			});
+		}
+		printf("%8i %14.2f %14.2f %14.2f\n", frames, period, poolTime, groupTime);
+	}
+	return 0;
+}
@@ -0,0 +1,41 @@
+#include <powercores/block_barrier.hpp>
+#include <powercores/utilities.hpp>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace powercores {
+
+BlockBarrier::BlockBarrier(int spinIterations): spin_iterations(spinIterations) {
+}
+
+void BlockBarrier::arm(int count) {
+	remaining.store(count, std::memory_order_release);
+}
+
+void BlockBarrier::arrive() {
+	if(remaining.fetch_sub(1, std::memory_order_seq_cst) != 1) return;
+	//We're last. If the waiter went to sleep, wake it.
+	//The waiter sets waiter_sleeping before checking remaining, so one of us is guaranteed to see the other.
+	if(waiter_sleeping.load(std::memory_order_seq_cst)) {
+		std::lock_guard<std::mutex> l(mutex);
+		condvar.notify_one();
+	}
+}
+
+void BlockBarrier::wait() {
+	for(int i = 0; i < spin_iterations; i++) {
+		if(remaining.load(std::memory_order_acquire) <= 0) return;
+		spinBackoff(i);
+	}
+	std::unique_lock<std::mutex> l(mutex);
+	waiter_sleeping.store(1, std::memory_order_seq_cst);
+	while(remaining.load(std::memory_order_seq_cst) > 0) condvar.wait(l);
+	waiter_sleeping.store(0, std::memory_order_relaxed);
+}
+
+void BlockBarrier::setSpinIterations(int iterations) {
+	spin_iterations = iterations;
+}
+
+}
@@ -0,0 +1,108 @@
+#include <powercores/realtime_worker_group.hpp>
+#include <powercores/bounded_queues.hpp>
+#include <powercores/block_barrier.hpp>
+#include <powercores/utilities.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace powercores {
+
+RealtimeWorkerGroup::RealtimeWorkerGroup(int threadCount, int spinIterations): thread_count(threadCount), spin_iterations(spinIterations), completion(spinIterations) {
+}
+
+RealtimeWorkerGroup::~RealtimeWorkerGroup() {
+	if(running) stop();
+}
+
+void RealtimeWorkerGroup::start() {
+	running = true;
+	workers.resize(thread_count);
+	for(auto &i: workers) i.reset(new Worker());
+	for(int i = 0; i < thread_count; i++) {
+		workers[i]->thread = safeStartThread(&RealtimeWorkerGroup::workerThreadFunction, this, i);
+	}
+}
+
+void RealtimeWorkerGroup::stop() {
+	//A task with no function tells the worker to exit.
+	for(auto &i: workers) post(*i, Task());
+	for(auto &i: workers) i->thread.join();
+	workers.clear();
+	running = false;
+}
+
+void RealtimeWorkerGroup::setThreadCount(int n) {
+	bool wasRunning = running;
+	if(wasRunning) stop();
+	thread_count = n;
+	if(wasRunning) start();
+}
+
+int RealtimeWorkerGroup::getThreadCount() {
+	return thread_count;
+}
+
+bool RealtimeWorkerGroup::isRunning() {
+	return running;
+}
+
+void RealtimeWorkerGroup::setSpinIterations(int iterations) {
+	spin_iterations = iterations;
+	completion.setSpinIterations(iterations);
+}
+
+void RealtimeWorkerGroup::setThreadStartCallback(std::function<void(void)> callback) {
+	thread_start_callback = callback;
+}
+
+void RealtimeWorkerGroup::dispatch(int count, void (*func)(void*, int), void* context) {
+	completion.arm(count-1);
+	Task task;
+	task.func = func;
+	task.context = context;
+	for(int i = 1; i < count; i++) {
+		task.index = i;
+		post(*workers[i-1], task);
+	}
+}
+
+void RealtimeWorkerGroup::post(Worker &worker, Task task) {
+	//The mailbox only ever holds a batch and possibly a stop request, so this can't spin for long.
+	for(int i = 0; worker.mailbox.enqueue(task) == false; i++) spinBackoff(i);
+	//Pairs with the fence in workerThreadFunction: either we see that the worker is asleep, or it sees the task.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(worker.sleeping.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> l(worker.mutex);
+		worker.condvar.notify_one();
+	}
+}
+
+void RealtimeWorkerGroup::workerThreadFunction(int id) {
+	Worker &worker = *workers[id];
+	if(thread_start_callback) thread_start_callback();
+	Task task;
+	while(true) {
+		bool got = false;
+		for(int i = 0; i < spin_iterations && got == false; i++) {
+			got = worker.mailbox.dequeue(task);
+			if(got == false) spinBackoff(i);
+		}
+		if(got == false) {
+			std::unique_lock<std::mutex> l(worker.mutex);
+			worker.sleeping.store(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			while((got = worker.mailbox.dequeue(task)) == false) worker.condvar.wait(l);
+			worker.sleeping.store(0, std::memory_order_relaxed);
+		}
+		if(task.func == nullptr) break;
+		task.func(task.context, task.index);
+		completion.arrive();
+	}
+}
+
+}
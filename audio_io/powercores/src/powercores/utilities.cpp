@@ -3,6 +3,11 @@
 #include <thread>
 #include <vector>
 #include <functional>
+#include <new>
+#include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 namespace powercores {
 
@@ -14,6 +19,25 @@ long long getThreadId() {
 	return id;
 }
 
+void* CacheLineAligned::operator new(std::size_t size) {
+	void* ret = nullptr;
+	#ifdef _WIN32
+	ret = _aligned_malloc(size, 64);
+	#else
+	if(posix_memalign(&ret, 64, size) != 0) ret = nullptr;
+	#endif
+	if(ret == nullptr) throw std::bad_alloc();
+	return ret;
+}
+
+void CacheLineAligned::operator delete(void* ptr) {
+	#ifdef _WIN32
+	_aligned_free(ptr);
+	#else
+	free(ptr);
+	#endif
+}
+
 //Helper class for atThreadExitImpl.
 class AtThreadExitImplHelper {
 	public:
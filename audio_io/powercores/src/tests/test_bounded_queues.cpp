@@ -0,0 +1,99 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+
+#include <powercores/bounded_queues.hpp>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <stdio.h>
+
+bool testSpsc() {
+	powercores::SpscQueue<int> q{64};
+	int total = 1000000;
+	long long expected = (long long)total*(total-1)/2, got = 0;
+	bool ordered = true;
+	std::thread consumer([&] () {
+		int item, last = -1;
+		for(int i = 0; i < total; i++) {
+			while(q.dequeue(item) == false) std::this_thread::yield();
+			if(item != last+1) ordered = false;
+			last = item;
+			got += item;
+		}
+	});
+	for(int i = 0; i < total; i++) {
+		while(q.enqueue(i) == false) std::this_thread::yield();
+	}
+	consumer.join();
+	return ordered && got == expected;
+}
+
+bool testMpmc() {
+	powercores::MpmcQueue<int> q{128};
+	int threads = 4, perThread = 100000;
+	std::atomic<long long> accumulator{0};
+	std::atomic<int> consumed{0};
+	std::vector<std::thread> thread_array;
+	for(int i = 0; i < threads; i++) {
+		thread_array.emplace_back([&] () {
+			for(int j = 0; j < perThread; j++) {
+				while(q.enqueue(1) == false) std::this_thread::yield();
+			}
+		});
+		thread_array.emplace_back([&] () {
+			int item;
+			for(int j = 0; j < perThread; j++) {
+				while(q.dequeue(item) == false) std::this_thread::yield();
+				accumulator.fetch_add(item);
+				consumed.fetch_add(1);
+			}
+		});
+	}
+	for(auto &t: thread_array) t.join();
+	int item;
+	return accumulator.load() == threads*perThread && q.dequeue(item) == false;
+}
+
+bool testFull() {
+	powercores::SpscQueue<int> s{4};
+	powercores::MpmcQueue<int> m{4};
+	for(int i = 0; i < 4; i++) {
+		if(s.enqueue(i) == false || m.enqueue(i) == false) return false;
+	}
+	return s.enqueue(4) == false && m.enqueue(4) == false;
+}
+
+//The counters are padded onto their own cache lines, which only helps if the queue starts on one.
+bool testAlignment() {
+	bool aligned = true;
+	for(int i = 0; i < 16; i++) {
+		auto s = new powercores::SpscQueue<int>(4);
+		auto m = new powercores::MpmcQueue<int>(4);
+		if(reinterpret_cast<uintptr_t>(s) % 64 || reinterpret_cast<uintptr_t>(m) % 64) aligned = false;
+		delete s;
+		delete m;
+	}
+	return aligned;
+}
+
+int main() {
+	printf("Testing bounded queues\n");
+	if(testFull() == false) {
+		printf("Bounded queues accepted items while full.\n");
+		return 1;
+	}
+	if(testAlignment() == false) {
+		printf("Queues allocated with new are not on cache line boundaries.\n");
+		return 1;
+	}
+	if(testSpsc() == false) {
+		printf("Single producer single consumer queue test failed.\n");
+		return 1;
+	}
+	if(testMpmc() == false) {
+		printf("Multiproducer multiconsumer queue test failed.\n");
+		return 1;
+	}
+	printf("Bounded queue tests passed.\n");
+	return 0;
+}
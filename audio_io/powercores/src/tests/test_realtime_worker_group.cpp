@@ -0,0 +1,45 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+
+#include <powercores/realtime_worker_group.hpp>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <stdio.h>
+
+int main() {
+	printf("Testing realtime worker group\n");
+	int threads = 4;
+	int iterations = 20000;
+	std::atomic<int> started{0};
+	powercores::RealtimeWorkerGroup group{threads, 100};
+	group.setThreadStartCallback([&] () {started.fetch_add(1);});
+	group.start();
+	std::vector<int> hits(threads+1), expected(threads+1);
+	for(int iteration = 0; iteration < iterations; iteration++) {
+		//Vary the batch size, so that some workers sleep through some batches.
+		int count = 1+iteration%(threads+1);
+		group.run(count, [&] (int index) {
+			hits[index]++;
+		});
+		//run must not return before every index has executed.
+		for(int i = 0; i < count; i++) expected[i]++;
+		for(int i = 0; i < threads+1; i++) {
+			if(hits[i] != expected[i]) {
+				printf("Index %i was not run before run returned.\n", i);
+				printf("Realtime worker group test failed.\n");
+				return 1;
+			}
+		}
+	}
+	group.setThreadCount(2);
+	group.run(3, [&] (int index) {hits[index]++;});
+	group.stop();
+	if(started.load() != threads+2) {
+		printf("Thread start callback ran %i times.\n", started.load());
+		printf("Realtime worker group test failed.\n");
+		return 1;
+	}
+	printf("Realtime worker group test passed.\n");
+	return 0;
+}
@@ -0,0 +1,68 @@
+/**This file is part of powercores, released under the terms of the Unlicense.
+See LICENSE in the root of the powercores repository for details.*/
+
+#include <powercores/work_stealing_deque.hpp>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <stdio.h>
+
+int main() {
+	printf("Testing work stealing deque\n");
+	int rounds = 200;
+	int itemsPerRound = 5000;
+	int thieves = 4;
+	powercores::WorkStealingDeque<int> deque{itemsPerRound};
+	std::vector<std::atomic<int>> seen(itemsPerRound);
+	std::atomic<int> consumed{0}, round{-1}, finished{0};
+	std::vector<std::thread> thread_array;
+	for(int i = 0; i < thieves; i++) {
+		thread_array.emplace_back([&] () {
+			for(int r = 0; r < rounds; r++) {
+				while(round.load() < r) std::this_thread::yield();
+				int item;
+				while(consumed.load() < itemsPerRound) {
+					if(deque.steal(item)) {
+						seen[item].fetch_add(1);
+						consumed.fetch_add(1);
+					}
+				}
+				finished.fetch_add(1);
+			}
+		});
+	}
+	for(int r = 0; r < rounds; r++) {
+		for(auto &i: seen) i.store(0);
+		consumed.store(0);
+		deque.reset();
+		round.store(r);
+		//Interleave pushes and pops so that the owner races the thieves for the last item.
+		int item;
+		for(int i = 0; i < itemsPerRound; i++) {
+			deque.push(i);
+			if(i%3 == 0 && deque.pop(item)) {
+				seen[item].fetch_add(1);
+				consumed.fetch_add(1);
+			}
+		}
+		while(deque.pop(item)) {
+			seen[item].fetch_add(1);
+			consumed.fetch_add(1);
+		}
+		//Wait for the thieves to leave this round before the next reset.
+		while(finished.load() < thieves*(r+1)) std::this_thread::yield();
+		for(int i = 0; i < itemsPerRound; i++) {
+			if(seen[i].load() != 1) {
+				printf("Item %i was consumed %i times.\n", i, seen[i].load());
+				printf("Work stealing deque test failed.\n");
+				round.store(rounds);
+				consumed.store(itemsPerRound);
+				for(auto &t: thread_array) t.detach();
+				return 1;
+			}
+		}
+	}
+	for(auto &t: thread_array) t.join();
+	printf("Work stealing deque test passed.\n");
+	return 0;
+}
@@ -56,7 +56,8 @@ class EnvironmentInfo {
 
 /**The sorce and environment model does not use the standard node and implementation separation.
 
-Sources write directly to special buffers in the environment, which are then copied to the environment's output in the process method.
+Sources write directly to special buffers in the environment, which are then summed into the environment's output in the process method.
+Sources can run on different threads at the same time, so every thread gets its own set of buffers, a bus.
 */
 
 class EnvironmentNode: public Node {
@@ -67,6 +68,7 @@ class EnvironmentNode: public Node {
 	//Maybe change our output channels.
 	//Also update sources, which might reconfigure themselves.
 	virtual void willTick() override;
+	virtual void threadsChanged(int threads) override;
 	virtual void process() override;
 	//Force overrides and short circuits the property modification checks, and is used by the constructor.
 	void updateEnvironmentInfo(bool force = false);
@@ -80,18 +82,28 @@ class EnvironmentNode: public Node {
 	int addEffectSend(int channels, bool isReverb, bool connecctByDefault);
 	EffectSendConfiguration& getEffectSend(int which);
 	int getEffectSendCount();
-	//This is a public variable; sources write directly to these buffers.
+	//Sources write directly to the buffers returned by this.
 	//There are always at least 8 buffers, with additional buffers appended for effect sends.
-	std::vector<float*> source_buffers;
+	//Only call from a source's process; the bus belongs to the calling thread.
+	float** getBus();
 	private:
+	//One bus per planner thread, indexed by Planner::getCurrentWorker.
+	std::vector<std::vector<float*>> buses;
+	//Which buses were written this block. Not vector<bool>, because each thread writes its own flag at the same time.
+	std::vector<char> bus_used;
+	std::vector<int> used_buses;
+	int bus_channels = 8;
+	void addBus();
 	//while these may be parents (through virtue of the panners we give out), they also have to hold a reference to us-and that reference must be strong.
 	//the world is more capable of handling a source that dies than a source a world that dies.
 	std::set<std::weak_ptr<SourceNode>, std::owner_less<std::weak_ptr<SourceNode>>> sources;
+	//The same, for checking new connections for cycles without the server's lock. Guarded by the server's topology mutex.
+	std::set<std::weak_ptr<SourceNode>, std::owner_less<std::weak_ptr<SourceNode>>> staged_sources;
 	std::shared_ptr<HrtfData > hrtf;
 	EnvironmentInfo environment_info;
 	std::vector<EffectSendConfiguration> effect_sends;
 	
-	template<typename JobT, typename CallableT, typename... ArgsT>
+	template<bool staged, typename JobT, typename CallableT, typename... ArgsT>
 	friend void environmentVisitDependencies(JobT&& start, CallableT &&callable, ArgsT&&... args);
 	//This is used to make play_async not invalidate the plan.
 	std::vector<std::tuple<std::shared_ptr<BufferNode>, std::shared_ptr<SourceNode>>> play_async_source_cache;
@@ -34,6 +34,8 @@ class BufferPlayer {
 	//Increments every time the buffer ends.
 	int getEndedCount();
 	void setEndedCount(int c);
+	//True if process will do nothing until the position, looping, or buffer changes.
+	bool getEnded();
 	private:
 	std::shared_ptr<Buffer> buffer = nullptr;
 	int frame = 0;
@@ -165,4 +167,8 @@ inline void BufferPlayer::setEndedCount(int c) {
 	ended_count = c;
 }
 
+inline bool BufferPlayer::getEnded() {
+	return ended || buffer_length == 0;
+}
+
 }
\ No newline at end of file
@@ -6,10 +6,15 @@ https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 o
 <LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
 carrying such notice may not be copied, modified, or distributed except according to those terms. */
 #pragma once
-#include <kiss_fftr.h>
+#include "../private/memory.hpp"
+#include <vector>
+#include <memory>
 
 namespace libaudioverse_implementation {
 
+class Fft;
+class ResponseSpectrum;
+
 class BlockConvolver {
 	public:
 	BlockConvolver(int blockSize);
@@ -33,20 +38,83 @@ class FftConvolver {
 	void convolve(float* input, float* output);
 	//Convolve with an fft of the input.
 	//This fft must meet a size requirement, queerieable by getFftSize().
-	//Must be computed with kiss_fftr.
-	void convolveFft(kiss_fft_cpx *fft, float* output);
+	//Must be computed with an Fft of that size, in split format.
+	void convolveFft(float* real, float* imag, float* output);
 	//If using convolveFft, this is the size to which the input must be zero-padded.
 	int getFftSize();
-	//Returns an fft of the input that can be used with fftConvolve.
-	//This fft will be valid until either getFft or convolve is called.
+	//Writes an fft of the input that can be used with convolveFft; the arrays need getFftSize()/2+1 floats.
 	//This exists for a very very few special cases in Libaudioverse.
-	kiss_fft_cpx* getFft(float* input);
+	void getFft(float* input, float* real, float* imag);
 	void reset();
 	private:
 	int block_size = 0, fft_size = 0, tail_size= 0, workspace_size = 0;
 	float*workspace = nullptr, *tail = nullptr;
-	kiss_fft_cpx *response_fft = nullptr, *block_fft = nullptr;
-	kiss_fftr_cfg fft = nullptr, ifft = nullptr;
+	float* block_real = nullptr, *block_imag = nullptr;
+	std::shared_ptr<ResponseSpectrum> response_spectrum;
+	Fft* fft = nullptr;
+};
+
+/**Uniformly partitioned overlap-save convolution.
+
+The response is cut into block-sized partitions, and we keep the fft of each.
+Those come from the response spectrum cache, so convolvers with the same response share them.
+Every block, the fft of the most recent input goes into a ring of past input spectra (the frequency-domain delay line),
+and the output is one inverse fft of the sum of each past spectrum times the matching partition.
+Per-block cost is two small ffts plus one complex multiply-accumulate per partition, instead of two ffts the size of the whole response.
+There is no latency beyond the block, the same as FftConvolver.*/
+class PartitionedConvolver {
+	public:
+	PartitionedConvolver(int blockSize);
+	//Starts with this response, which saves working out the default one just to throw it away.
+	PartitionedConvolver(int blockSize, int length, const float* response);
+	~PartitionedConvolver();
+	//Note: zeros the history if the number of partitions changes.
+	void setResponse(int length, const float* response);
+	void convolve(float* input, float* output);
+	void reset();
+	int getPartitionCount();
+	private:
+	int block_size = 0, fft_size = 0, partition_size = 0, bin_count = 0, stride = 0;
+	int partition_count = 0, newest = 0;
+	//The last fft_size samples of input, oldest first.
+	float* input_history = nullptr, *workspace = nullptr;
+	std::shared_ptr<ResponseSpectrum> response_spectrum;
+	//Split into real and imaginary parts so the multiply-accumulate can use SIMD; partition i starts at i*stride.
+	float* delay_line_real = nullptr, *delay_line_imag = nullptr;
+	float* accumulator_real = nullptr, *accumulator_imag = nullptr;
+	Fft* fft = nullptr;
+};
+
+class ConvolutionLevel;
+
+/**Non-uniformly partitioned convolution, for responses of many seconds.
+
+The first block of the response is done on the calling thread, so there's no latency.
+For small blocks that's in the time domain; past max_time_domain_head samples, a single-partition PartitionedConvolver is cheaper.
+The rest is split into levels of PartitionedConvolvers whose partitions double in size, two partitions per level, up to a maximum size which the last level uses for everything left.
+A level with partitions of size P collects P samples of input, then hands them to the background job workers; the result isn't needed until P samples later.
+So the calling thread does the same small amount of work every block however long the response is, and the big ffts happen elsewhere.
+Retirable so that nodes can swap them out while rendering; see Server::retire.*/
+class NonuniformConvolver: public Retirable {
+	public:
+	NonuniformConvolver(int blockSize);
+	~NonuniformConvolver();
+	//Note: this zeros the history.
+	void setResponse(int length, float* response);
+	void convolve(float* input, float* output);
+	void reset();
+	int getLevelCount();
+	int getResponseLength();
+	private:
+	void clearLevels();
+	int block_size = 0, response_length = 1;
+	//Exactly one of these.
+	BlockConvolver* time_domain_head = nullptr;
+	PartitionedConvolver* fft_head = nullptr;
+	std::vector<ConvolutionLevel*> levels;
+	//The levels' results, added in as they finish. Starts at block ring_position.
+	float* output_ring = nullptr;
+	int output_ring_size = 0, ring_position = 0;
 };
 
 }
\ No newline at end of file
@@ -151,6 +151,13 @@ enum Lav_NODE_STATES {
 	Lav_NODESTATE_ALWAYS_PLAYING,
 };
 
+/**How audio threads are scheduled.*/
+enum Lav_SCHEDULING_POLICIES {
+	Lav_SCHEDULING_POLICY_NORMAL,
+	Lav_SCHEDULING_POLICY_FIFO,
+	Lav_SCHEDULING_POLICY_ROUND_ROBIN,
+};
+
 /**Logging levels.*/
 enum Lav_LOGGING_LEVELS {
 	Lav_LOGGING_LEVEL_CRITICAL = 10,
@@ -224,6 +231,14 @@ Lav_PUBLIC_FUNCTION LavError Lav_serverWriteFile(LavHandle serverHandle, const c
 
 Lav_PUBLIC_FUNCTION LavError Lav_serverSetThreads(LavHandle serverHandle, int threads);
 Lav_PUBLIC_FUNCTION LavError Lav_serverGetThreads(LavHandle serverHandle, int* destination);
+/**Configure the threads which process audio: the server's workers, and whatever thread calls into the output device.*/
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetSchedulingPolicy(LavHandle serverHandle, int policy, int priority);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetCpuAffinity(LavHandle serverHandle, int cpuCount, int* cpus);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetFlushDenormals(LavHandle serverHandle, int flushDenormals);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetLockMemory(LavHandle serverHandle, int lockMemory);
+Lav_PUBLIC_FUNCTION LavError Lav_serverGetCriticalPathCost(LavHandle serverHandle, double* destination);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetBufferPooling(LavHandle serverHandle, int pooling);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetQueuePropertyWrites(LavHandle serverHandle, int queue);
 
 Lav_PUBLIC_FUNCTION LavError Lav_serverCallIn(LavHandle serverHandle, double when, int inAudioThread, LavTimeCallback cb, void* userdata);
 
@@ -292,6 +307,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_automationSet(LavHandle nodeHandle, int slot, d
 Lav_PUBLIC_FUNCTION LavError Lav_automationEnvelope(LavHandle nodeHandle, int slot, double time, double duration, int valuesLength, double *values);
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeReset(LavHandle nodeHandle);
+Lav_PUBLIC_FUNCTION LavError Lav_nodeGetProcessingCost(LavHandle nodeHandle, double* destination);
 
 Lav_PUBLIC_FUNCTION LavError Lav_createSineNode(LavHandle serverHandle, LavHandle* destination);
 Lav_PUBLIC_FUNCTION LavError Lav_createAdditiveSquareNode(LavHandle serverHandle, LavHandle* destination);
@@ -153,6 +153,10 @@ enum Lav_CONVOLVER_PROPERTIES {
 	Lav_CONVOLVER_IMPULSE_RESPONSE = -1,
 };
 
+enum Lav_FFT_CONVOLVER_PROPERTIES {
+	Lav_FFT_CONVOLVER_CROSSFADE_TIME = -1,
+};
+
 enum Lav_THREE_BAND_EQ_PROPERTIES {
 	Lav_THREE_BAND_EQ_HIGHBAND_DBGAIN = -1,
 	Lav_THREE_BAND_EQ_HIGHBAND_FREQUENCY = -2,
@@ -7,8 +7,11 @@ https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 o
 carrying such notice may not be copied, modified, or distributed except according to those terms. */
 #pragma once
 #include "../private/node.hpp"
-#include <map>
+#include "../private/timer_wheel.hpp"
 #include <memory>
+#include <vector>
+#include <utility>
+#include <stdint.h>
 
 namespace libaudioverse_implementation {
 
@@ -24,9 +27,18 @@ class BufferTimelineNode: public Node {
 	void scheduleBuffer(double time, float delta, std::shared_ptr<Buffer> buffer);
 	void reset() override;
 	private:
-	std::multimap<double, BufferPlayer*> scheduled_buffers;
+	//Players come from and go back to a pool, so that steady state scheduling doesn't allocate.
+	BufferPlayer* acquirePlayer();
+	void releasePlayer(BufferPlayer* player);
+	//Keyed by the tick in which the buffer should start; the time is checked again when it comes out.
+	TimerWheel<std::pair<double, BufferPlayer*>> scheduled_buffers;
+	//These are reserved to hold every player we own, so that the audio thread never grows them.
+	std::vector<std::pair<double, BufferPlayer*>> due_buffers;
+	std::vector<BufferPlayer*> playing, free_players;
+	int player_count = 0;
 	std::vector<float*> workspace;
 	double time = 0.0;
+	uint64_t ticks = 0;
 	int output_channels = 0;
 };
 
@@ -12,7 +12,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 namespace libaudioverse_implementation {
 
 class Server;
-class FftConvolver;
+class NonuniformConvolver;
 
 class FftConvolverNode: public Node {
 	public:
@@ -20,9 +20,24 @@ class FftConvolverNode: public Node {
 	~FftConvolverNode();
 	virtual void process();
 	void setResponse(int channel, int length, float* response);
+	//Checks the file, then loads it on the server's background thread; the old response plays until the new one is ready.
 	void setResponseFromFile(std::string path, int fileChannel, int convolverChannel);
+	//Called by the background load. Takes ownership of convolver, and drops it if another response was set for the channel since the load started.
+	void publishResponse(int channel, int generation, NonuniformConvolver* convolver);
+	private:
+	void swapInResponse(int channel);
+	void crossfadeOutResponse(int channel);
+	//Hands a convolver to the server's background thread to be deleted, without locking or allocating.
+	void retire(NonuniformConvolver* convolver);
 	int channels;
-	FftConvolver **convolvers;
+	NonuniformConvolver **convolvers;
+	//Per channel: a loaded response waiting for the start of a block, and the old one being crossfaded away from.
+	NonuniformConvolver **incoming, **outgoing;
+	int *crossfade_positions, *crossfade_lengths;
+	//Counts calls that set each channel's response, so that loads which finish after a newer call can be thrown out.
+	int *response_generations;
+	float* crossfade_workspace = nullptr;
+	int longest_response = 0;
 };
 
 std::shared_ptr<Node> createFftConvolverNode(std::shared_ptr<Server> server, int channels);
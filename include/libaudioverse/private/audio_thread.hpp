@@ -6,10 +6,46 @@ https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 o
 <LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
 carrying such notice may not be copied, modified, or distributed except according to those terms. */
 #pragma once
+#include "../libaudioverse.h"
+#include <vector>
+
 namespace libaudioverse_implementation {
+
+/**How threads which process audio should be set up.  Each server has one of these.
+Anything a platform can't do is ignored.*/
+class AudioThreadConfiguration {
+	public:
+	int scheduling_policy = Lav_SCHEDULING_POLICY_NORMAL;
+	int priority = 0;
+	//Audio threads are pinned to these round-robin by worker index. Empty means don't pin.
+	std::vector<int> cpus;
+	//Denormals are very slow on x86, and decaying filter and reverb tails are full of them.
+	bool flush_denormals = true;
+	//Threads remember which configuration they last applied, so becoming an audio thread again is almost free.
+	//Call this after any modification.
+	void markChanged();
+	unsigned int generation = 0;
+};
+
 //Called on a thread that process audio. Attempts to turn us itno an audio thread.
 //This functionn may raise our priority or otherwise register us.
-void becomeAudioThread();
+//worker picks the CPU from the configuration's list.
+//Dedicated threads belong to us, so unbecomeAudioThread leaves them alone; this avoids reconfiguring device threads every block.
+void becomeAudioThread(const AudioThreadConfiguration &config, int worker = 0, bool dedicated = false);
+//Put the thread back the way it was, unless it's dedicated.
 void unbecomeAudioThread();
+//Lock all of the process's memory, so that the audio threads never page fault, or let go of a lock taken earlier.
+//Memory stays locked while any lock hasn't been let go of, so every successful true needs a matching false.
+//Returns false if the platform refused or can't, in which case nothing changed.
+bool lockProcessMemory(bool lock);
+
+//While one of these is alive, the thread is rendering: it must not destroy objects or free memory, so anything that dies goes to the server's graveyard instead.
+//These nest. Server::getBlock and the planner's workers make them.
+class RenderingScope {
+	public:
+	RenderingScope();
+	~RenderingScope();
+};
+bool isRenderingThread();
 
-}
\ No newline at end of file
+}
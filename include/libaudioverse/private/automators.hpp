@@ -6,10 +6,13 @@ https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 o
 <LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
 carrying such notice may not be copied, modified, or distributed except according to those terms. */
 #pragma once
+#include "memory.hpp"
+#include <memory>
 
 namespace libaudioverse_implementation {
 
 class Property;
+class Node;
 
 /**The automators.
 
@@ -21,9 +24,10 @@ An automator itself must be equivalent to a pure function with some parameters.
 Put another way, multiple calls to start *must* be supported.
 Furthermore, all automators must have a well-defined final value.
 
-Subclasses should set duration in their constructors, should they need to continue past their scheduled time.*/
+Subclasses should set duration in their constructors, should they need to continue past their scheduled time.
+Properties finish and drop automators while rendering, so they retire them to the server rather than deleting them.*/
 
-class Automator {
+class Automator: public Retirable {
 	public:
 	Automator(Property* p, double scheduledTime);
 	virtual ~Automator();
@@ -31,9 +35,15 @@ class Automator {
 	//default implementation: initial_value and initial_time are set.
 	virtual void start(double initialValue, double initialTime) ;
 	virtual double getValue(double time) = 0;
+	//Render count samples starting at first into destination, where sample i is at time+i/sr.
+	//The default calls getValue for each sample; subclasses should override this with something that works on whole runs.
+	virtual void renderBlock(double time, double sr, int first, int count, double* destination);
 	virtual double getFinalValue() = 0;
 	double getDuration();
 	double getScheduledTime();
+	//For automators which were made before the time they're relative to and their property were known; see Server::applyPropertyCommands.
+	void setScheduledTime(double t);
+	void setProperty(Property* p);
 
 	protected:
 	double initial_value = 0.0, initial_time = 0.0, scheduled_time = 0.0, duration = 0.0;
@@ -42,4 +52,12 @@ class Automator {
 
 bool compareAutomators(Automator *a, Automator *b);
 
+//The first sample in [first, last) whose time is at least boundary, or last if there isn't one.
+//Sample i is at time+i/sr, computed exactly as Property::tick does so that the two agree at the edges.
+int firstSampleAtOrAfter(double boundary, double time, double sr, int first, int last);
+
+//If node's server queues property writes, queue automator to be scheduled time seconds from now and return true.
+//Otherwise, or if it can't be queued, delete it and return false; the caller then takes the lock and schedules a new one itself.
+bool queueAutomator(std::shared_ptr<Node> node, int slot, double time, Automator* automator);
+
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#pragma once
+#include <atomic>
+
+namespace libaudioverse_implementation {
+
+/**Audio work that is allowed to take longer than a block, done by a small pool of worker threads shared by the whole process.
+
+The audio thread submits a job and calls finish at the job's deadline, some blocks later.
+If no worker has started it by then, finish runs it right there; otherwise finish waits for the worker.
+So results never depend on whether the workers kept up, only how much of the work the audio thread ended up doing.
+Submitting and finishing never lock or allocate.
+
+Workers take jobs with lower priority numbers first. Give jobs with nearer deadlines lower numbers.*/
+class BackgroundJob {
+	public:
+	virtual ~BackgroundJob() {}
+	virtual void run() = 0;
+	//The job must be finished, or never submitted.
+	void submit(int priority);
+	void finish();
+	//Finishes the job and waits until no worker is holding it. Call this from the destructor of anything that submits itself.
+	void drain();
+	//Called by the workers.
+	void runFromWorker();
+	private:
+	std::atomic<int> state{0}, references{0};
+};
+
+//How many priorities there are; anything higher uses the last.
+const int background_job_priorities = 8;
+
+void initializeBackgroundJobs();
+void shutdownBackgroundJobs();
+
+}
@@ -8,7 +8,10 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #pragma once
 #include <memory>
 #include <set>
+#include <map>
 #include <vector>
+#include <utility>
+#include "job.hpp"
 
 namespace libaudioverse_implementation {
 
@@ -17,20 +20,35 @@ class Server;
 
 //we need weak pointers to this in OutputConnection.
 class InputConnection;
+class OutputConnection;
+class TopologyCommit;
+
+/**What the audio thread sees of an InputConnection.
+Snapshots are never modified. The public API changes the connection itself, then publishes a new snapshot in a TopologyCommit.*/
+class InputConnectionSnapshot {
+	public:
+	std::vector<std::shared_ptr<OutputConnection>> outputs;
+	//Keeps the nodes alive for as long as the audio thread can see them.
+	std::vector<std::shared_ptr<Node>> nodes;
+};
 
 class OutputConnection {
 	public:
 	//start: index of the output buffer at which this connection begins.
 	//count: the number of adjacent output buffers to which this connection applies.
 	OutputConnection(std::shared_ptr<Server> server, Node* node, int start, int count);
-	void add(int inputBufferCount, float** inputBuffers, bool shouldApplyMixingMatrix);
+	//Returns false if we were silent, in which case nothing was added.
+	bool add(int inputBufferCount, float** inputBuffers, bool shouldApplyMixingMatrix);
+	//True if our node is paused or produced only zeros this block.
+	bool isSilent();
 	void reconfigure(int newStart, int newCount);
-	void clear();
-	void connectHalf(std::shared_ptr<InputConnection> inputConnection);
-	void disconnectHalf(std::shared_ptr<InputConnection> connection);
 	int getStart() {return start;}
 	int getCount() {return count;}
 	Node* getNode();
+	//The rest of these need the server's topology mutex.
+	void clear(TopologyCommit &commit);
+	void connectHalf(std::shared_ptr<InputConnection> inputConnection);
+	void disconnectHalf(std::shared_ptr<InputConnection> connection);
 	std::vector<Node*> getConnectedNodes();
 	private:
 	Node* node = nullptr;
@@ -41,16 +59,20 @@ class OutputConnection {
 /**Unlike output connections, input connections may have a null node, so long as the nodeless functions are used.
 this is to prevent needing to make special case code for server.
 
-Input connections keep nodes alive.*/
+Input connections keep nodes alive.
+
+Connections are staged: the public API edits connected_to under the server's topology mutex, and the audio thread only ever reads the current snapshot.
+Functions which read the snapshot need the server's lock, or to be on the audio thread.*/
 class InputConnection {
 	public:
 	InputConnection(std::shared_ptr<Server> server, Node* node, int start, int count);
-	void add(bool applyMixingMatrix); //calls out to the output connections this owns, no further parameters are needed.
-	void addNodeless(float** inputs, bool shouldApplyMixingMatrix);
+	~InputConnection();
+	//These call out to the output connections this owns, and return false if all of them were silent.
+	bool add(bool applyMixingMatrix);
+	bool addNodeless(float** inputs, bool shouldApplyMixingMatrix);
+	//True if everything connected to us is silent.
+	bool isSilent();
 	void reconfigure(int start, int count);
-	void connectHalf(std::shared_ptr<OutputConnection>outputConnection);
-	void disconnectHalf(std::shared_ptr<OutputConnection> connection);
-	void forgetConnection(OutputConnection* which);
 	int getStart() {return start;}
 	int getCount() {return count;}
 	Node* getNode();
@@ -59,16 +81,53 @@ class InputConnection {
 	
 	template<typename CallableT, typename... ArgsT>
 	void visitInputs(CallableT&& callable, ArgsT&&... args) {
+		for(auto &i: snapshot->nodes) callable(i, args...);
+	}
+	//Like visitInputs, but gives the raw output connections.
+	template<typename CallableT, typename... ArgsT>
+	void visitOutputs(CallableT&& callable, ArgsT&&... args) {
+		for(auto &i: snapshot->outputs) callable(i.get(), args...);
+	}
+
+	//The rest of these work on the staged connections, and need the server's topology mutex.
+	void connectHalf(std::shared_ptr<OutputConnection>outputConnection);
+	void disconnectHalf(std::shared_ptr<OutputConnection> connection);
+	void forgetConnection(OutputConnection* which);
+	//Like visitInputs, for checking connections before they're published.
+	template<typename CallableT, typename... ArgsT>
+	void visitStagedInputs(CallableT&& callable, ArgsT&&... args) {
 		for(auto &i: connected_to) callable(i.second, args...);
 	}
+	InputConnectionSnapshot* makeSnapshot();
+	//Needs the server's lock. Makes newSnapshot current and returns the old one, which the caller now owns.
+	InputConnectionSnapshot* swapSnapshot(InputConnectionSnapshot* newSnapshot);
 	private:
 	Node* node;
 	int start, count, block_size;
 	std::map<std::shared_ptr<OutputConnection>, std::shared_ptr<Node>> connected_to;
+	InputConnectionSnapshot* snapshot = nullptr;
+};
+
+/**A batch of connection changes, published to the audio thread all at once.
+Made under the server's topology mutex and handed to Server::commitTopology, which snapshots every changed input.
+The audio thread applies commits at the start of a block, and then they hold the old snapshots until the server frees them on another thread.*/
+class TopologyCommit {
+	public:
+	~TopologyCommit();
+	//Call after changing input's staged connections.
+	void inputChanged(std::shared_ptr<InputConnection> input);
+	std::vector<std::pair<std::shared_ptr<InputConnection>, InputConnectionSnapshot*>> snapshots;
+	//Jobs to tell the planner about; see Planner::invalidateDependencies and Planner::invalidateDependents.
+	//The server is a flag rather than a job here, since holding it would keep it alive.
+	std::vector<std::shared_ptr<Job>> changed_dependencies, changed_dependents;
+	bool server_changed = false;
+	//Servers keep commits in intrusive lists.
+	TopologyCommit* next = nullptr;
 };
 
-void makeConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input);
-void breakConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input);
+//These need the server's topology mutex.
+void makeConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input, TopologyCommit &commit);
+void breakConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input, TopologyCommit &commit);
 
 
 }
\ No newline at end of file
@@ -20,33 +20,42 @@ namespace libaudioverse_implementation {
 Instead, everything was moved here.
 
 To create a node that overrides its dependency management, add a template here and then insert a case in the final template in this file.
-Be sure to order the final template from most to least specific.*/
+Be sure to order the final template from most to least specific.
 
-template<typename  JobT, typename CallableT, typename... ArgsT>
+The planner sees the connections the audio thread does.
+With staged set, we instead see connections as the public API has made them, which might not be published yet; this needs the server's topology mutex.*/
+
+template<bool staged, typename CallableT, typename... ArgsT>
+inline void visitConnectionInputs(std::shared_ptr<InputConnection> &conn, CallableT&& callable, ArgsT&&... args) {
+	if(staged) conn->visitStagedInputs(callable, args...);
+	else conn->visitInputs(callable, args...);
+}
+
+template<bool staged, typename  JobT, typename CallableT, typename... ArgsT>
 inline void serverVisitDependencies(JobT&& start, CallableT&& callable, ArgsT&&... args) {
-	start->final_output_connection->visitInputs(callable, args...);
+	visitConnectionInputs<staged>(start->final_output_connection, callable, args...);
 	filterWeakPointers(start->always_playing_nodes, [](std::shared_ptr<Node> &n, CallableT &callable, ArgsT&&... args2) {
 		auto j = std::static_pointer_cast<Job>(n);
 		callable(j, args2...);
 	}, callable, args...);
 }
 
-template<typename JobT, typename CallableT, typename... ArgsT>
+template<bool staged, typename JobT, typename CallableT, typename... ArgsT>
 inline void nodeVisitDependencies(JobT&& start, CallableT&& callable, ArgsT&&... args) {
 	for(int i = 0; i < start->getInputConnectionCount(); i++) {
-		start->getInputConnection(i)->visitInputs(callable, args...);
+		auto conn = start->getInputConnection(i);
+		visitConnectionInputs<staged>(conn, callable, args...);
 	}
-	for(auto &p: start->properties) {
-		auto &prop = p.second;
+	for(auto &prop: start->properties) {
 		auto conn = prop.getInputConnection();
-		if(conn) conn->visitInputs(callable, args...);
+		if(conn) visitConnectionInputs<staged>(conn, callable, args...);
 	}	
 }
 
-template<typename JobT, typename CallableT, typename... ArgsT>
+template<bool staged, typename JobT, typename CallableT, typename... ArgsT>
 inline void environmentVisitDependencies(JobT&& start, CallableT&& callable, ArgsT&&... args) {
 	//dependencies: all our sources.
-	for(auto w: start->sources) {
+	for(auto w: staged ? start->staged_sources : start->sources) {
 		auto n = w.lock();
 		if(n) {
 			auto j = std::static_pointer_cast<Job>(n);
@@ -56,13 +65,19 @@ inline void environmentVisitDependencies(JobT&& start, CallableT&& callable, Arg
 }
 
 
-#define TRY(type, name)  auto casted##type = std::dynamic_pointer_cast<type>(start); if(casted##type) {name(casted##type, callable, args...);return;}
-
-template<typename JobT, typename CallableT, typename... ArgsT>
+//Every job is either the server or a node, so the type tells us which of the above to use without a chain of dynamic casts.
+template<bool staged = false, typename JobT, typename CallableT, typename... ArgsT>
 inline void visitDependencies(JobT &&start, CallableT&& callable, ArgsT&&... args) {
-	TRY(Server, serverVisitDependencies)
-	TRY(EnvironmentNode, environmentVisitDependencies)
-	TRY(Node, nodeVisitDependencies)
+	switch(start->getType()) {
+		case Lav_OBJTYPE_SERVER:
+		serverVisitDependencies<staged>(std::static_pointer_cast<Server>(start), callable, args...);
+		break;
+		case Lav_OBJTYPE_ENVIRONMENT_NODE:
+		environmentVisitDependencies<staged>(std::static_pointer_cast<EnvironmentNode>(start), callable, args...);
+		break;
+		default:
+		nodeVisitDependencies<staged>(std::static_pointer_cast<Node>(start), callable, args...);
+	}
 }
 
 }
@@ -0,0 +1,72 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#pragma once
+#include <memory>
+
+namespace libaudioverse_implementation {
+
+/**Real ffts.
+
+Spectra are in split format: a transform of size n has n/2+1 bins, with the real parts in one array and the imaginary parts in another.
+This is what the complex kernels in kernels.hpp want.
+Neither direction scales, so a forward transform followed by an inverse one multiplies by the size.
+
+A plan holds everything about a size which never changes, i.e. twiddles, and is shared by everyone who asks for that size.
+Plans are immutable, so any number of threads can use one at once; the scratch space lives in Fft, below.*/
+class FftPlan {
+	public:
+	virtual ~FftPlan() {}
+	int getSize();
+	int getBinCount();
+	//How many floats of scratch space forward and inverse need.
+	int getScratchSize();
+	const char* getBackendName();
+	//Input is size samples and isn't modified.
+	virtual void forward(float* input, float* outReal, float* outImag, float* scratch) = 0;
+	//Doesn't modify the spectrum.
+	virtual void inverse(float* inReal, float* inImag, float* output, float* scratch) = 0;
+	protected:
+	int size = 0, bin_count = 0, scratch_size = 0;
+	const char* backend_name = "";
+};
+
+/**An fft of one size, plus the scratch space to do it with.
+Use one of these per thread; they're cheap, because the plan is shared.*/
+class Fft {
+	public:
+	Fft(int size);
+	~Fft();
+	void forward(float* input, float* outReal, float* outImag);
+	void inverse(float* inReal, float* inImag, float* output);
+	int getSize();
+	int getBinCount();
+	const char* getBackendName();
+	private:
+	std::shared_ptr<FftPlan> plan;
+	float* scratch = nullptr;
+};
+
+//The smallest size at least atLeast which the best backend can do quickly.
+//Sizes which don't come from here work, but may be slow.
+int getFftSize(int atLeast);
+
+//Threadsafe. Plans live as long as the cache or anyone using them.
+std::shared_ptr<FftPlan> getFftPlan(int size);
+
+void initializeFft();
+void shutdownFft();
+
+//The backends. Only getFftPlan should call these.
+FftPlan* createKissFftPlan(int size);
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+//Powers of 2 from simd_fft_minimum_size up.
+const int simd_fft_minimum_size = 32;
+FftPlan* createSimdFftPlan(int size);
+#endif
+
+}
@@ -0,0 +1,96 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+namespace libaudioverse_implementation {
+
+class ExternalObject;
+
+/**Maps the handles we give to the outside world to objects.
+
+A handle is a slot index in the low bits and the slot's generation above it.  Releasing a slot bumps its generation, so handles to dead objects stop resolving rather than finding whatever lives in the slot next.
+Freed slots are only reused once plenty of others are free, so a stale handle would have to outlive thousands of generations of its slot to alias anything.
+
+Lookups don't lock anything.  A reader pins the slot by incrementing a count in its state word, but only if the generation matches and no writer has it, copies out the weak pointer, and unpins.
+Everything else takes the table's mutex, sets the writer bit, and waits for pins to drain before touching a slot.
+Slots live in fixed-size chunks which are never freed, so readers never see a slot move.*/
+class HandleTable {
+	public:
+	HandleTable();
+	~HandleTable();
+	//For ExternalObject's constructor.  Throws Lav_ERROR_MEMORY if the table is full.
+	int allocate();
+	//For ExternalObject's destructor.  The handle stops resolving, and the slot can eventually be reused.
+	void release(int handle);
+	//Make obj resolvable, and keep a strong reference to it for the outside world.
+	void publish(std::shared_ptr<ExternalObject> obj);
+	//The outside world let go; the object stays resolvable for as long as something else keeps it alive.
+	void dropStrongReference(int handle);
+	void dropAllStrongReferences();
+	//Every published object that's still alive.
+	std::vector<std::shared_ptr<ExternalObject>> getLiveObjects();
+	//nullptr if the handle doesn't resolve; otherwise the object and, in type, its Lav_OBJTYPE.
+	std::shared_ptr<ExternalObject> lookup(int handle, int &type);
+
+	private:
+	static const int index_bits = 20, generation_bits = 11;
+	static const uint32_t index_mask = (1u << index_bits)-1, max_generation = (1u << generation_bits)-1;
+	static const int chunk_bits = 10, chunk_size = 1 << chunk_bits, chunk_count = 1 << (index_bits-chunk_bits);
+	//The state word is generation << 32, then the writer bit, then the pin count.
+	static const uint64_t writer_bit = 1ull << 31, pin_mask = writer_bit-1;
+	//How many slots have to be free before we start reusing them.
+	static const unsigned int reuse_threshold = 1024;
+
+	class Slot {
+		public:
+		std::atomic<uint64_t> state{1ull << 32};
+		std::weak_ptr<ExternalObject> object;
+		int type = 0;
+		//Only touched with the mutex held; readers never look at it.
+		std::shared_ptr<ExternalObject> strong;
+	};
+
+	Slot* getSlot(uint32_t index);
+	//With the mutex held.
+	void beginWrite(Slot& slot);
+	void endWrite(Slot& slot, uint64_t generation);
+
+	std::atomic<Slot*> chunks[chunk_count];
+	std::mutex mutex;
+	std::deque<uint32_t> free_indices;
+	uint32_t next_index = 0;
+};
+
+inline HandleTable::Slot* HandleTable::getSlot(uint32_t index) {
+	Slot* chunk = chunks[index >> chunk_bits].load(std::memory_order_acquire);
+	if(chunk == nullptr) return nullptr;
+	return chunk+(index & (chunk_size-1));
+}
+
+inline std::shared_ptr<ExternalObject> HandleTable::lookup(int handle, int &type) {
+	if(handle <= 0) return nullptr;
+	uint64_t generation = (uint32_t)handle >> index_bits;
+	Slot* slot = getSlot((uint32_t)handle & index_mask);
+	if(slot == nullptr) return nullptr;
+	uint64_t state = slot->state.load(std::memory_order_acquire);
+	do {
+		if((state >> 32) != generation || (state & writer_bit)) return nullptr;
+	} while(slot->state.compare_exchange_weak(state, state+1, std::memory_order_acquire, std::memory_order_acquire) == false);
+	std::weak_ptr<ExternalObject> object = slot->object;
+	type = slot->type;
+	slot->state.fetch_sub(1, std::memory_order_release);
+	return object.lock();
+}
+
+}
@@ -9,7 +9,6 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <powercores/thread_local_variable.hpp>
 #include <string>
 #include <memory>
-#include <kiss_fftr.h>
 #include <tuple>
 
 namespace libaudioverse_implementation {
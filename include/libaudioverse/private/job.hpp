@@ -18,9 +18,8 @@ This file is for the Job base class, and reduces dependencies on powercores.*/
 namespace libaudioverse_implementation {
 
 class Job;
+class Planner;
 
-//Places jobs into their bins.
-void binner(std::shared_ptr<Job> job, int tag, std::map<int, std::vector<std::shared_ptr<Job>>> &destination);
 /**Compares smart pointers to jobs: terue if job a comes-before job b.
 bool jobComparer(const std::shared_ptr<Job> &a, const std::shared_ptr<Job> &b);
 
@@ -31,11 +30,28 @@ class  Job: public ExternalObject {
 	virtual ~Job() {}
 	virtual void execute() {}
 	virtual bool canCull() {return false;}
+	//Called by the planner before we next run, whenever what we depend on has changed.
+	//Anything derived from our connections can be worked out here once instead of every block.
+	virtual void dependenciesChanged() {}
+	//Called by the planner when compiling. If dependency isn't null, it runs immediately before us on the same thread, and we are the only job that depends on it.
+	virtual void setFusedDependency(Job* dependency) {}
+	//Seconds per block spent in execute, as measured by the planner. 0 if we haven't run yet.
+	double getAverageCost() {return average_cost;}
+	//Called with the server's lock, never during execute, with whether the server pools buffers; see Server::updateBufferPooling.
+	//Returns how many buffers we want from the pool, or 0 to keep our own. If nonzero, they're in pooled_buffers whenever execute is called.
+	virtual int usePooledBuffers(bool pooling) {return 0;}
+	//What usePooledBuffers last returned. The planner asks this when compiling, so that only usePooledBuffers allocates.
+	virtual int getPooledBufferCount() {return 0;}
+	protected:
+	//Only valid during execute.  Other jobs use them as soon as we return, so nothing we put in them survives.
+	float** pooled_buffers = nullptr;
 	private:
-	bool job_recorded = false;
-	friend void binner(std::shared_ptr<Job> job, int tag, std::map<int, std::vector<std::shared_ptr<Job>>> &destination);
+	//Our slot in the plan, or -1 if we aren't in it.
+	int plan_index = -1;
+	//An exponential moving average, so that one slow block doesn't reorder everything.
+	double average_cost = 0.0;
+	bool measured_cost = false;
 	friend class Planner;
-	friend void jobExecutor(std::shared_ptr<Job> &j); //Used by the planner to run jobs.
 };
 
 }
\ No newline at end of file
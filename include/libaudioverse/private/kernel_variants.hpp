@@ -0,0 +1,51 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#pragma once
+
+namespace libaudioverse_implementation {
+
+struct KernelTable;
+
+/**Every implementation of the dispatched kernels in kernels.hpp.
+Only the kernels themselves and the dispatcher should include this; everyone else calls through kernel_table.
+
+The simple versions are plain C++ and work everywhere. The SIMD versions use them for leftovers.*/
+void uninterleaveSamplesSimple(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs);
+void interleaveSamplesSimple(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output);
+void additionKernelSimple(int length, float* a1, float* a2, float* dest);
+void scalarAdditionKernelSimple(int length, float c, float* a1, float* dest);
+void scalarMultiplicationKernelSimple(int length, float c, float* a1, float* dest);
+void multiplicationKernelSimple(int length, float* a1, float* a2, float* dest);
+void multiplicationAdditionKernelSimple(int length, float c, float* a1, float* a2, float* dest);
+void arrayMultiplicationAdditionKernelSimple(int length, float* a1, float* mul, float* add, float* dest);
+void multiplicationScalarAdditionKernelSimple(int length, float* a1, float* mul, float c, float* dest);
+void parallelMultiplicationAdditionKernelSimple(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out);
+float dotKernelSimple(int length, const float* v1, const float* v2);
+void complexMultiplicationAdditionKernelSimple(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag);
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+void additionKernelSse2(int length, float* a1, float* a2, float* dest);
+void scalarAdditionKernelSse2(int length, float c, float* a1, float* dest);
+void scalarMultiplicationKernelSse2(int length, float c, float* a1, float* dest);
+void multiplicationKernelSse2(int length, float* a1, float* a2, float* dest);
+void multiplicationAdditionKernelSse2(int length, float c, float* a1, float* a2, float* dest);
+void arrayMultiplicationAdditionKernelSse2(int length, float* a1, float* mul, float* add, float* dest);
+void multiplicationScalarAdditionKernelSse2(int length, float* a1, float* mul, float c, float* dest);
+void parallelMultiplicationAdditionKernelSse2(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out);
+float dotKernelSse2(int length, const float* v1, const float* v2);
+void complexMultiplicationAdditionKernelSse2(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag);
+#endif
+
+//These live in files built with the matching compiler flags, so they must never be called unless cpuid says so.
+//Each one replaces every entry of the table it has a version of.
+#if defined(LIBAUDIOVERSE_USE_AVX)
+void installAvx2Kernels(KernelTable &table);
+void installAvx512Kernels(KernelTable &table);
+#endif
+
+}
@@ -9,29 +9,97 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 namespace libaudioverse_implementation {
 
+/**Most of the hot kernels have one implementation per instruction set.
+All of them are built into the same binary, and initializeKernels fills this table with the best ones the CPU can run.
+Until then, and on CPUs with nothing better, it holds the SSE2 ones if they were compiled in.
+The variants themselves are in kernel_variants.hpp; nothing outside the kernels should need them.*/
+struct KernelTable {
+	void (*uninterleave)(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs);
+	void (*interleave)(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output);
+	void (*addition)(int length, float* a1, float* a2, float* dest);
+	void (*scalarAddition)(int length, float c, float* a1, float* dest);
+	void (*scalarMultiplication)(int length, float c, float* a1, float* dest);
+	void (*multiplication)(int length, float* a1, float* a2, float* dest);
+	void (*multiplicationAddition)(int length, float c, float* a1, float* a2, float* dest);
+	void (*arrayMultiplicationAddition)(int length, float* a1, float* mul, float* add, float* dest);
+	void (*multiplicationScalarAddition)(int length, float* a1, float* mul, float c, float* dest);
+	void (*parallelMultiplicationAddition)(int length, float c1, float c2, float c3, float c4,  float* a1, float* a2, float* out);
+	float (*dot)(int length, const float* v1, const float* v2);
+	void (*complexMultiplicationAddition)(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag);
+};
+
+extern KernelTable kernel_table;
+//Checks the CPU with cpuid and fills kernel_table. Called from Lav_initialize.
+void initializeKernels();
+//For logging: "AVX-512", "AVX2", "SSE2", or "none".
+const char* getKernelInstructionSet();
+
 /**InInterleaving and uninterleaving of samples.
 
 Should the output count be less than channels, uninterleaving will only use the first outputCount channels.
 Should the input count be less than channels, interleaving will assume zero for all remaining channels.
 These two cases are rare and mainly exist to enable code reuse for getting blocks out of the server itself.*/
-void uninterleaveSamples(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs);
-void interleaveSamples(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output);
+inline void uninterleaveSamples(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs) {
+	kernel_table.uninterleave(channels, frames, samples, outputCount, outputs);
+}
+
+inline void interleaveSamples(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output) {
+	kernel_table.interleave(channels, frames, inputCount, inputs, output);
+}
 
 //primitive math operations.
 //It is safe to use these such that dest==a1 or dest==a2.
-void additionKernel(int length, float* a1, float* a2, float* dest);
-void scalarAdditionKernel(int length, float c, float*a1, float* dest);
-void scalarMultiplicationKernel(int length, float c, float* a1, float* dest);
-void multiplicationKernel(int length, float* a1, float* a2, float* dest);
+inline void additionKernel(int length, float* a1, float* a2, float* dest) {
+	kernel_table.addition(length, a1, a2, dest);
+}
+
+inline void scalarAdditionKernel(int length, float c, float*a1, float* dest) {
+	kernel_table.scalarAddition(length, c, a1, dest);
+}
+
+inline void scalarMultiplicationKernel(int length, float c, float* a1, float* dest) {
+	kernel_table.scalarMultiplication(length, c, a1, dest);
+}
+
+inline void multiplicationKernel(int length, float* a1, float* a2, float* dest) {
+	kernel_table.multiplication(length, a1, a2, dest);
+}
 
 //multiply a1 by c, sum with a2, and store result in dest.
 //a1==dest and a2==dest are, again, safe.
-void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, float* dest);
+inline void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, float* dest) {
+	kernel_table.multiplicationAddition(length, c, a1, a2, dest);
+}
+
+//The same, but with both multiplier and addend per sample: dest = a1*mul+add.
+inline void arrayMultiplicationAdditionKernel(int length, float* a1, float* mul, float* add, float* dest) {
+	kernel_table.arrayMultiplicationAddition(length, a1, mul, add, dest);
+}
+
+//dest = a1*mul+c.
+inline void multiplicationScalarAdditionKernel(int length, float* a1, float* mul, float c, float* dest) {
+	kernel_table.multiplicationScalarAddition(length, a1, mul, c, dest);
+}
+
 //A parallel version, if we can, primarily used by convolution.
 //This is equivalent to calling multiplicationAdditionKernel 4 times, advancing the  a1 pointer by 1 each time.
 //This implies that a1 must be at least 3 elements longer than a2.
 //Note that if a1 and a2 are the same buffers, this will be problematic; if they are, a2-a1 must be greater than 3.
-void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float c3, float c4,  float* a1, float* a2, float* out);
+inline void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float c3, float c4,  float* a1, float* a2, float* out) {
+	kernel_table.parallelMultiplicationAddition(length, c1, c2, c3, c4, a1, a2, out);
+}
+
+//Complex multiply-accumulate on spectra stored as separate real and imaginary arrays: dest += a*b.
+//Used by the partitioned convolver, which spends most of its time here.
+inline void complexMultiplicationAdditionKernel(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag) {
+	kernel_table.complexMultiplicationAddition(length, aReal, aImag, bReal, bImag, destReal, destImag);
+}
+
+//Narrows doubles to floats.
+void doubleToFloatKernel(int length, double* source, float* dest);
+
+//Writes start, start+step, start+2*step... to dest.  Used to render automation, so it works in doubles.
+void rampKernel(int length, double start, double step, double* dest);
 
 /**The convolution kernel.
 The first response-1 samples of the input buffer are assumed to be a running history, so the actual length of the input buffer needs to be outputSampleCount+responseLength-1.
@@ -57,5 +125,7 @@ Note that this allocates with new[] because it just forwards onto speex_resample
 void staticResamplerKernel(int inputSr, int outputSr, int channels, int frames, float* data, int *framesOut, float** dataOut);
 
 /**Dot two vectors.*/
-float dotKernel(int length, const float* v1, const float* v2);
+inline float dotKernel(int length, const float* v1, const float* v2) {
+	return kernel_table.dot(length, v1, v2);
+}
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <atomic>
 #include <functional>
 #include "macros.hpp"
+#include "handle_table.hpp"
 //contains some various memory-related bits and pieces, as well as the smart pointer marshalling.
 
 namespace libaudioverse_implementation {
@@ -29,13 +30,13 @@ This also implements Lav_free, which works the same for all pointers, and the ob
 
 class ExternalObject;//declared in this header below the globals.
 class Server;
+class Node;
+class Buffer;
 
 extern std::map<void*, std::shared_ptr<void>> *external_ptrs;
-extern std::map<int, std::shared_ptr<ExternalObject>> *external_handles;
-extern std::map<int, std::weak_ptr<ExternalObject>> *weak_external_handles;
+//Every handle we've given out. Looking handles up doesn't need memory_lock.
+extern HandleTable *handle_table;
 extern std::recursive_mutex *memory_lock;
-//max handle we've used for an outgoing object. Ensures no duplication.
-extern std::atomic<int> *max_handle;
 
 class ExternalObject: public std::enable_shared_from_this<ExternalObject>  {
 	public:
@@ -47,6 +48,17 @@ class ExternalObject: public std::enable_shared_from_this<ExternalObject>  {
 	//Have we been put in the dict yet?
 	bool has_external_mapping = false;
 	std::atomic<int> refcount;
+	//Links dead objects waiting in their server's graveyard.
+	ExternalObject* graveyard_next = nullptr;
+};
+
+/**Something a rendering thread is done with that isn't an ExternalObject, such as an automator.
+Hand it to Server::retire and the server's background thread deletes it.*/
+class Retirable {
+	public:
+	virtual ~Retirable() {}
+	//Links retired objects waiting for their server's background thread.
+	Retirable* retired_next = nullptr;
 };
 
 template <class t>
@@ -76,34 +88,72 @@ int outgoingObject(std::shared_ptr<t> what) {
 		what->is_first_external_access = true;
 		what->has_external_mapping = true;
 		what->refcount.store(1);
-		(*external_handles)[what->external_object_handle] = what;
-		(*weak_external_handles)[what->external_object_handle] = what;
+		handle_table->publish(what);
 	}
 	return what->external_object_handle;
 }
 
+/**Lets incomingObject check an object's type against its Lav_OBJTYPE rather than with dynamic_pointer_cast.
+
+The classes most of the API asks for are specialized below.  Anything else falls back to the cast.*/
+template<class t>
+class ExternalObjectTypeTag {
+	public:
+	static const bool has_tag = false;
+	static bool matches(int type) {
+		return false;
+	}
+};
+
+template<>
+class ExternalObjectTypeTag<ExternalObject> {
+	public:
+	static const bool has_tag = true;
+	static bool matches(int type) {
+		return true;
+	}
+};
+
+template<>
+class ExternalObjectTypeTag<Server> {
+	public:
+	static const bool has_tag = true;
+	static bool matches(int type) {
+		return type == Lav_OBJTYPE_SERVER;
+	}
+};
+
+template<>
+class ExternalObjectTypeTag<Buffer> {
+	public:
+	static const bool has_tag = true;
+	static bool matches(int type) {
+		return type == Lav_OBJTYPE_BUFFER;
+	}
+};
+
+template<>
+class ExternalObjectTypeTag<Node> {
+	public:
+	static const bool has_tag = true;
+	static bool matches(int type) {
+		return type >= Lav_OBJTYPE_GENERIC_NODE;
+	}
+};
+
 template<class t>
 std::shared_ptr<t> incomingObject(int handle, bool allowNull =false) {
 	if(allowNull&& handle==0) return nullptr;
-	std::lock_guard<std::recursive_mutex> guard(*memory_lock);
-	if(external_handles->count(handle)) {
-		auto res=std::dynamic_pointer_cast<t>(external_handles->at(handle));
-		if(res == nullptr) ERROR(Lav_ERROR_TYPE_MISMATCH, "Incoming pointer did not match requested type.");
-		return res;
-	}
-	else if(weak_external_handles->count(handle)) {
-		auto weak_res = weak_external_handles->at(handle);
-		auto strong_res = weak_res.lock();
-		auto res = std::dynamic_pointer_cast<t>(strong_res);
-		if(res ) return res;
-		//The dynamic cast failing means we have a strong_res.
-		//Not having a handle means no strong_res.
-		else if(res == nullptr && strong_res != nullptr) ERROR(Lav_ERROR_TYPE_MISMATCH, "Incoming pointer did not match requested type.");
-		else weak_external_handles->erase(handle);
+	int type;
+	auto obj = handle_table->lookup(handle, type);
+	if(obj == nullptr) ERROR(Lav_ERROR_INVALID_HANDLE, "Handle did not originate from Libaudioverse or was deleted.");
+	if(ExternalObjectTypeTag<t>::has_tag) {
+		if(ExternalObjectTypeTag<t>::matches(type) == false) ERROR(Lav_ERROR_TYPE_MISMATCH, "Incoming pointer did not match requested type.");
+		return std::static_pointer_cast<t>(obj);
 	}
-	ERROR(Lav_ERROR_INVALID_HANDLE, "Handle did not originate from Libaudioverse or was deleted.");
-	//we can't get here, but some compilers probably complain anyway:
-	return nullptr;
+	auto res = std::dynamic_pointer_cast<t>(obj);
+	if(res == nullptr) ERROR(Lav_ERROR_TYPE_MISMATCH, "Incoming pointer did not match requested type.");
+	return res;
 }
 
 void initializeMemoryModule();
@@ -146,6 +196,8 @@ bool isAligned(const void* ptr);
 
 //custom deleter for smart pointer that guarantees thread safety.
 std::function<void(ExternalObject*)> ObjectDeleter(std::shared_ptr<Server> server);
+//What ObjectDeleter actually does, once it's safe. Server must be locked.
+void destroyExternalObject(Server* server, ExternalObject* obj);
 
 
 }
\ No newline at end of file
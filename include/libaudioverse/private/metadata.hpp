@@ -7,12 +7,39 @@ https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 o
 carrying such notice may not be copied, modified, or distributed except according to those terms. */
 #pragma once
 #include <map>
+#include <vector>
 #include "properties.hpp"
 
 namespace libaudioverse_implementation {
 
+/**Where each property of a node type lives in the node's dense property array.
+
+Slots are the public property identifiers, which are all negative.  This is built once per node type by the metadata module and shared by every node of that type.*/
+class PropertyLayout {
+	public:
+	void setSlots(std::vector<int> s);
+	//The index of slot in the property array, or -1 if this node type doesn't have it.
+	int getIndex(int slot) const {
+		if(slot > 0 || -slot >= (int)indices.size()) return -1;
+		return indices[-slot];
+	}
+	int getCount() const {
+		return (int)slots.size();
+	}
+	//Index to slot.
+	const std::vector<int>& getSlots() const {
+		return slots;
+	}
+	private:
+	std::vector<int> slots;
+	//Negated slot to index.
+	std::vector<int> indices;
+};
+
 void initializeMetadata();
-std::map<int, Property> makePropertyTable(int objtype);
+const PropertyLayout* getPropertyLayout(int objtype);
+//The default properties for objtype, in the order given by its layout.
+std::vector<Property> makePropertyArray(int objtype);
 const char* getGitRevision();
 const char* getCompilerCFlags();
 const char* getCompilerCxxFlags();
@@ -21,6 +21,8 @@ carrying such notice may not be copied, modified, or distributed except accordin
 namespace libaudioverse_implementation {
 
 class Property;
+class PropertySlotInfo;
+class PropertyLayout;
 class InputConnection;
 class OutputConnection;
 
@@ -80,21 +82,32 @@ class Node: public Job {
 	virtual void tick();
 	//override this one instead. Default implementation merely zeros the outputs.
 	virtual void process();
-	//Apply mul and add.
-	virtual void applyMul();
-	virtual void applyAdd();
+	//Apply mul and add, in one pass over each output.
+	virtual void applyMulAdd();
 	//zero the output buffers.
 	virtual void zeroOutputBuffers();
 	virtual void zeroInputBuffers();
+	//True if every output is zero this block. Only meaningful once we've ticked, so to our dependents.
+	bool isSilent();
+	//True if nothing connected to our inputs made any sound this block.
+	bool areInputsSilent();
 	//Does some cleanup and the like.
 	//This is also an override point for subclasses that may need to do cleanup periodically in order to remain performant; in that case, they *must* call the base. Or else.
 	virtual void doMaintenance();
 	//Called after the server is locked but before ticking, in some arbetrary order. We must be registered for this.
 	//It is safe to change connections here.
 	virtual void willTick();
+	//Called with the lock when the server's thread count changes, before the planner uses the new threads.
+	//Per-thread state has to be made here, since rendering can't allocate.
+	virtual void threadsChanged(int threads);
 	
 	std::shared_ptr<Server> getServer();
 	Property& getProperty(int slot, bool allowForwarding = true);
+	//Safe without the lock, unlike getProperty, since forwarding and destruction rewrite what that resolves to.
+	//Null for slots we don't have, or before standardNodeCreation calls makePropertySlotInfo.
+	const PropertySlotInfo* getPropertySlotInfo(int slot);
+	//Snapshots every slot's type, read-only flag, and static range once the node is fully constructed.
+	void makePropertySlotInfo();
 
 	//Property forwarding support.
 	void forwardProperty(int ourProperty, std::shared_ptr<Node> toNode, int toProperty);
@@ -104,6 +117,8 @@ class Node: public Job {
 	void removePropertyBackref(int ourProperty, std::shared_ptr<Node> toNode, int toProperty);
 	//call pred on all the properties that immediately forward to which.
 	void visitPropertyBackrefs(int which, std::function<void(Property&)> pred);
+	//Recomputes where slot goes, then does the same for everything forwarded to it.
+	void resolvePropertyForwarding(int slot);
 
 
 	//meet the lockable concept.
@@ -119,15 +134,41 @@ class Node: public Job {
 
 	//Conform to Job.
 	virtual void execute();
-
-	//True if we're paused.
+	//Rebuilds input_mix_list.
+	void dependenciesChanged() override;
+	void setFusedDependency(Job* dependency) override;
+	//Our inputs are only used while we tick, so they can come from the pool unless a subclass needs them longer.
+	int usePooledBuffers(bool pooling) override;
+	int getPooledBufferCount() override;
+
+	//True if we're paused, or asleep with nothing connected to us.
 	bool canCull() override;
 	
 	//Various optimizations that subclasses can enable.
 	void setShouldZeroOutputBuffers(bool v);
+	//Our output depends only on this block's input, so silence in is silence out and we needn't process it.
+	//Nodes which keep state between blocks or check werePropertiesModified in process must not set this.
+	void setIsStateless(bool v);
+	//Nodes with a tail, i.e. reverbs and delays, can go to sleep once their input has been silent long enough, and are then treated like paused nodes until their input makes a sound.
+	//If decays is false, seconds is how long our output takes to go silent after our input does.
+	//If decays is true, our output never quite gets there, so seconds is the longest it can stay quiet with more of the tail still to come, i.e. the longest delay line.
+	//We then sleep once it's stayed below -120 dB for that long.
+	//Negative means never sleep, which is the default.
+	void setTail(double seconds, bool decays = false);
+	bool isAsleep();
+	//Needs the lock. Properties call this when they change, since asleep we wouldn't tick them.
+	void wake();
 	protected:
 	std::shared_ptr<Server> server = nullptr;
-	std::map<int, Property> properties;
+	//Shared by every node of our type; maps slots to indices into properties.
+	const PropertyLayout* property_layout = nullptr;
+	//Dense and never resized, so pointers to these stay good.
+	std::vector<Property> properties;
+	//What getProperty returns for each index: the property itself, or whatever it's forwarded to.
+	//Forwarding keeps this up to date so that lookups don't have to check.
+	std::vector<Property*> resolved_properties;
+	//By index, like properties. Never changed once made, so the public API can read it without the lock.
+	std::vector<PropertySlotInfo> property_slot_info;
 	//the tuple is of (node, property).
 	std::map<int, std::tuple<std::weak_ptr<Node>, int>> forwarded_properties;
 	//These are the back references, used for property callbacks.
@@ -137,6 +178,24 @@ class Node: public Job {
 	std::vector<float*> output_buffers;
 	std::vector<std::shared_ptr<InputConnection>> input_connections;
 	std::vector<std::shared_ptr<OutputConnection>> output_connections;
+	//Every output connected to one of our inputs, paired with that input, so that tick doesn't need to walk maps or copy shared pointers.
+	//The input connections keep these alive, and the planner tells us when they change.
+	std::vector<std::pair<OutputConnection*, InputConnection*>> input_mix_list;
+	//If the planner fused us onto the end of another node's chain, that node. We're its only consumer.
+	Node* fused_dependency = nullptr;
+	//When it's safe, swap our input buffers with fused_dependency's output buffers instead of copying. Returns false if we have to mix normally.
+	bool takeFusedInput();
+	//process calls this if it left every output zeroed, so that the nodes reading them can skip them.
+	void markSilent();
+	bool is_silent = false;
+	//See setTail. Called after process with whether our input was silent and our output quiet.
+	void updateSleep(bool quiet);
+	bool isTailQuiet();
+	bool hasInputConnections();
+	int tail_samples = -1, quiet_samples = 0;
+	bool tail_decays = false, is_asleep = false;
+	//If true, input_buffers don't belong to us, and are pointed at pooled_buffers every tick.
+	bool has_pooled_inputs = false;
 	bool is_processing = false, is_suspended = false;
 	int num_input_buffers = 0, num_output_buffers = 0, block_size = 0;
 	//used to make no-op state changes free.
@@ -149,7 +208,9 @@ class Node: public Job {
 	
 	//various optimization flags.
 	bool should_zero_output_buffers = true; //Enable/disable zeroing output buffers on tick if node is unpaused.
-	template<typename JobT, typename CallableT, typename... ArgsT>
+	bool can_pool_inputs = true; //Disable if anything reads the input buffers outside tick.
+	bool is_stateless = false; //Enable/disable skipping process when all inputs are silent.
+	template<bool staged, typename JobT, typename CallableT, typename... ArgsT>
 	friend void nodeVisitDependencies(JobT&& start, CallableT&& callable, ArgsT&&... args);
 };
 
@@ -158,6 +219,8 @@ Every createXXX function uses this template.*/
 template<typename NodeT, typename... ArgsT>
 std::shared_ptr<NodeT> standardNodeCreation(std::shared_ptr<Server> server, ArgsT... args) {
 	std::shared_ptr<NodeT> ret(new NodeT(server, std::forward<ArgsT>(args)...), ObjectDeleter(server));
+	//Constructors adjust ranges, so this has to wait until they're done.
+	ret->makePropertySlotInfo();
 	server->associateNode(ret);
 	return ret;
 }
@@ -10,8 +10,12 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <set>
 #include <vector>
 #include <memory>
-#include <powercores/thread_pool.hpp>
+#include <atomic>
+#include <powercores/realtime_worker_group.hpp>
+#include <powercores/work_stealing_deque.hpp>
+#include <powercores/bounded_queues.hpp>
 #include "job.hpp"
+#include "audio_thread.hpp"
 
 /**job.hpp contains the rest of this code.*/
 
@@ -25,24 +29,142 @@ class Planner {
 	//Threads must be greater than 0.	
 	void execute(std::shared_ptr<Job> start, int threads = 1);
 	void runJobsSync();
-	void runJobsAsync();
+	void runJobsAsync(int threads);
 	
+	//True while execute is running, including while it updates the plan.
+	//Jobs must not be destroyed during this time; see ObjectDeleter in memory.cpp.
+	bool isExecuting();
+	//The longest chain of job costs from a root of the plan to the start, in seconds. No number of threads can finish a block faster.
+	double getCriticalPathCost();
+	//Which of our threads the caller is, from 0 to one less than the thread count passed to execute.
+	//The thread calling execute is always 0, as is any thread outside execute.
+	static int getCurrentWorker();
+	//Used for the threads that run jobs, including the one calling execute.
+	//Must not be called during execute.
+	void setAudioThreadConfiguration(const AudioThreadConfiguration &config);
+	//Whether jobs share transient buffers of blockSize samples; see Job::usePooledBuffers.
+	//Must not be called during execute.
+	void setBufferPooling(bool pooling, int blockSize);
+	//Makes room for a plan of this many jobs run on this many threads, so that compiling and running it don't allocate.
+	//Only room for dependents grows in execute, when updating the graph adds edges. Must not be called during execute.
+	void reserve(int jobs, int threads);
+	//Makes sure there are width pooled buffers for each of threads workers, so that execute never has to make them.
+	//Must not be called during execute.
+	void reserveBufferPool(int width, int threads);
+	//Throw the whole plan away.
 	void invalidatePlan();
+	//The dependencies of job changed: something was connected to or disconnected from it, its culling status changed, or it died.
+	//This is safe to call from destructors.
+	void invalidateDependencies(Job* job);
+	//Some of the connections from job's outputs were broken.
+	void invalidateDependents(Job* job);
+	//Like invalidateDependencies, but for a job that changes its own culling status while running.
+	//Safe to call from any worker; takes effect next block. Outside execute, it's the same as invalidateDependencies.
+	void invalidateDependenciesFromJob(Job* job);
 	private:
 	void replan(std::shared_ptr<Job> start);
-	//After every tick, kill the shared pointers so that we can let things die.
-	void clearStrongPlan();
-	//Initialize the strong version of the plan from the weak pointers.
-	//This can invalidate the plan.
-	void initializeStrongPlan();
-	std::map<int, std::vector<std::shared_ptr<Job>>> plan;
-	std::map<int, std::vector<std::weak_ptr<Job>>> weak_plan;
-	bool is_valid = false;
+	//Bring the graph up to date by revisiting only the jobs that were invalidated.
+	void applyChanges();
+	//Put a job which isn't yet in the plan into it, along with any of its dependencies that also aren't.
+	int addJob(std::shared_ptr<Job> job);
+	//Recompute the dependencies of the job at index and apply the difference to the graph.
+	void updateJob(int index, std::shared_ptr<Job> job);
+	//Take the job at index out of the graph, along with anything that was only in the plan because of it.
+	void removeJob(int index);
+	void markDirty(int index);
+	//Flatten the graph into the compiled plan.  Only called when the generation changes.
+	//This runs in execute, so everything it fills has room made ahead of time; see reserve.
+	void compile();
+	//Recompute priorities from the measured costs, and order everything by them.
+	void prioritize();
+	//The dependency-counting executor.
+	//Worker 0 is always the thread calling execute.
+	void workerLoop(int worker);
+	//Runs the compiled job at index, then releases its dependents.
+	//Returns the index of a dependent to run next on this thread, or -1.
+	int runJob(int index, int worker);
+
+	/**The plan is a graph which persists between blocks.
+	Jobs are given a slot the first time they're reached from the start, and keep it until nothing in the plan depends on them.
+	Culled jobs stay in the graph without dependencies, so that we can find what depends on them if they stop being culled.
+	Entries hold raw pointers.  Every job tells us when it dies, and the weak pointer is only used to notice that when the plan is next updated, never while running.*/
+	class PlanEntry {
+		public:
+		Job* job = nullptr;
+		std::weak_ptr<Job> weak_job;
+		//Both sorted.
+		std::vector<int> dependencies, dependents;
+		//How many of our dependencies actually run.
+		int dependency_count = 0;
+		bool in_use = false, culled = false, dirty = false;
+	};
+	std::vector<PlanEntry> entries;
+	std::vector<int> free_entries, dirty_entries;
+	int start_index = -1;
+	//How many dependencies there are between all the entries, so that compiled_dependents can be kept big enough.
+	size_t edge_count = 0;
+	//Bumped whenever the graph changes, so that we know to recompile.
+	unsigned int generation = 0, compiled_generation = 0;
+
+	/**The compiled plan is what actually runs: only the jobs which aren't culled, packed together, with dependents as ranges of compiled_dependents.
+	Running a block touches nothing else.
+	Linear chains, where each job is the only dependent of the one before, are fused into one compiled job and run back to back on one thread; jobs_begin and jobs_end are a range of compiled_jobs.*/
+	class CompiledJob {
+		public:
+		int jobs_begin = 0, jobs_end = 0;
+		int dependency_count = 0;
+		int dependents_begin = 0, dependents_end = 0;
+	};
+	std::vector<CompiledJob> compiled;
+	std::vector<Job*> compiled_jobs;
+	std::vector<int> compiled_dependents;
+	//Scratch space for compiling, indexed by entry and compiled job respectively.
+	std::vector<int> fused_predecessors, compiled_tails;
+	//Compiled indices such that every job comes after its dependencies.
+	std::vector<int> compiled_order;
+	/**A job's priority is the cost of the most expensive path from it to the end of the block, itself included.
+	Running the job with the highest priority first keeps the critical path moving, which is what bounds how long the block takes.
+	Dependents are sorted by priority in increasing order, and roots in decreasing order.*/
+	std::vector<double> priorities;
+	//Sum of the costs of the jobs in each compiled job.
+	std::vector<double> compiled_costs;
+	double critical_path_cost = 0.0;
+	//Costs drift, so every so often we redo the priorities even though the graph didn't change.
+	int blocks_since_prioritizing = 0;
+	//Scratch space for dealing roots to workers.
+	std::vector<double> worker_loads;
+	std::vector<int> root_workers;
+	//Maps entry indices to compiled indices while compiling.
+	std::vector<int> compiled_indices;
+	//Counts down as each compiled job's dependencies finish. It can run when this hits 0.
+	std::unique_ptr<std::atomic<int>[]> remaining_dependencies;
+	int remaining_dependencies_capacity = 0;
+	//Compiled jobs which can run as soon as the block starts.
+	std::vector<int> roots;
+	//An upper bound on how many jobs can ever be ready at once: the roots, plus one for every extra dependent beyond the first.
+	//If this is 1, the graph is a chain and threads can't help.
+	int max_parallelism = 0;
+	/**Buffer pooling.
+	Pooled buffers are only live while the job which asked for them runs, and a worker runs one job at a time.
+	So each worker needs only as many as the hungriest job in the plan, and every job it runs reuses the same ones, which then stay in cache.
+	The pool is pool_width buffers for each worker, one worker after another.
+	Jobs are moved in and out of the pool, and the pool grown, outside execute; see Server::updateBufferPooling. Compiling only counts.*/
+	bool buffer_pooling = false;
+	int pool_block_size = 0, pool_width = 0;
+	std::vector<float*> buffer_pool;
+	bool is_valid = false, is_executing = false;
 	std::weak_ptr<Job> last_start;
 	//For threads:
-	bool started_thread_pool = false;
+	bool started_workers = false;
 	int last_thread_count = 0;
-	powercores::ThreadPool thread_pool{0};
+	powercores::RealtimeWorkerGroup workers{0};
+	std::vector<std::unique_ptr<powercores::WorkStealingDeque<int>>> deques;
+	int active_worker_count = 0;
+	AudioThreadConfiguration audio_thread_configuration;
+	std::atomic<int> jobs_remaining{0};
+	//From invalidateDependenciesFromJob. If this fills, the job just stays in the plan.
+	//On the heap so that the queue's cache line alignment doesn't make the whole Planner over-aligned.
+	powercores::MpmcQueue<Job*>* job_invalidations = nullptr;
 };
 
 }
\ No newline at end of file
@@ -44,6 +44,12 @@ class Property {
 	explicit Property(int property_type);
 	~Property();
 	void associateNode(Node* node);
+	//Most properties are never automated or connected to, so the buffers for doing so aren't made until the first time.
+	//Call before connecting a node to us; scheduleAutomator calls it itself.
+	void allocateBuffers();
+	//Needs the lock. Makes the buffers and room for one more automator, so that scheduling a queued one later on the audio thread doesn't allocate.
+	void reserveAutomator();
+	Node* getAssociatedNode();
 	void associateServer(std::shared_ptr<Server> server);
 
 	void reset(bool avoidCallbacks = false);
@@ -55,6 +61,8 @@ class Property {
 	int getTag();
 	void setTag(int t);
 	bool isReadOnly();
+	//True if v is in range for an int, float, or double property. Other types have no range, so always true.
+	bool isInRange(double v);
 	void setReadOnly(bool what);
 	double getSr();
 	double getTime();
@@ -63,9 +71,14 @@ class Property {
 	bool wasModified();
 
 	void updateAutomatorIndex(double t);
-	void scheduleAutomator(Automator* automator);
+	//If reserved, this uses the room from an earlier reserveAutomator.
+	void scheduleAutomator(Automator* automator, bool reserved = false);
+	//True if automators are scheduled or running.
+	bool isAutomated();
 	//Cancels all automation after time t. T is relative to the property's current time.
 	void cancelAutomators(double time);
+	//Drops the automators from first on, handing them to the server to delete since this may be a rendering thread.
+	void retireAutomators(std::vector<Automator*>::iterator first);
 	//yes, really. This is as uggly as it looks.
 	int getIntValue();
 	void setIntValue(int v, bool avoidCallbacks = false);
@@ -80,6 +93,8 @@ class Property {
 	//The index of r1 must be strictly less than or equal to the index of r2.
 	//This condition may be lifted in future.
 	float getFloatValue(int i = 0);
+	//The whole block at once if this is an a-rate float property this block, otherwise nullptr.
+	float* getFloatValueBuffer();
 	void setFloatValue(float v, bool avoidCallbacks = false, bool avoidAutomatorClear = false);
 	float getFloatDefault();
 	void setFloatDefault(float v);
@@ -186,11 +201,17 @@ class Property {
 	unsigned int automator_index = 0;
 	double time = 0.0, sr = 0.0;
 	std::vector<Automator*> automators;
+	//How many queued automators reserveAutomator has made room for. automators always has room for this many more.
+	int reserved_automators = 0;
+	//Automators render here, since they need the precision.  Float properties then narrow it into float_value_buffer once per block so that reads don't convert.
 	double* value_buffer = nullptr;
+	float* float_value_buffer = nullptr;
 	bool should_use_value_buffer = false;
 	float* node_buffer=nullptr; //temporary place for putting node outputs.
 	std::shared_ptr<InputConnection> incoming_nodes = nullptr; //The nodes connected to this property. Pointer to break an include cycle.
 	
+	//Every write calls this. Stamps last_modified and wakes the node.
+	void markModified();
 	//Allows protecting against duplicate ticks.
 	int last_ticked=-1; //server starts at zero.
 	int last_modified = 0; //so we can detect writes. We are first written on tick 0.
@@ -200,6 +221,18 @@ class Property {
 	std::function<void(void)> post_changed_callback;
 };
 
+/**What the public API may check about a slot without the server's lock: see Node::getPropertySlotInfo.
+Copied from the node's own property once it's made, and never changed after.*/
+class PropertySlotInfo {
+	public:
+	PropertySlotInfo() = default;
+	explicit PropertySlotInfo(Property &prop);
+	//Same as Property::isInRange, for the range the property had when this was made.
+	bool isInRange(double v) const;
+	int type = 0;
+	bool read_only = false, has_dynamic_range = false;
+	double minimum = 0.0, maximum = 0.0;
+};
 
 //helper methods to quickly make properties.
 Property* createIntProperty(const char* name, int defaultValue, int min, int max);
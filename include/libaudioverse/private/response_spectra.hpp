@@ -0,0 +1,49 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#pragma once
+#include <memory>
+
+namespace libaudioverse_implementation {
+
+/**The spectrum of an impulse response, cut into partitions, in the split format the convolvers multiply with.
+
+Partition i is the fft of samples i*partitionSize up to (i+1)*partitionSize, zero-padded to fftSize.
+These never change once made, and they're shared: see getResponseSpectrum.*/
+class ResponseSpectrum {
+	public:
+	ResponseSpectrum(int fftSize, int partitionSize, int length, const float* response);
+	~ResponseSpectrum();
+	int getFftSize();
+	int getPartitionSize();
+	int getPartitionCount();
+	int getBinCount();
+	float* getReal(int partition);
+	float* getImag(int partition);
+	//True if this is the spectrum of exactly this response with these sizes.
+	bool matches(int fftSize, int partitionSize, int length, const float* response);
+	//Everything this is holding, in bytes.
+	long long getByteCount();
+	private:
+	int fft_size = 0, partition_size = 0, partition_count = 0, bin_count = 0, stride = 0, length = 0;
+	//A copy of the response, so that matches can rule out hash collisions.
+	float* samples = nullptr;
+	//Partition i starts at i*stride, so each is on its own cache lines.
+	float* real = nullptr, *imag = nullptr;
+};
+
+void initializeResponseSpectrumCache();
+void shutdownResponseSpectrumCache();
+
+//Threadsafe. Returns the cached spectrum if anyone is still using one for the same response and sizes, otherwise makes it.
+//Spectra are made without holding the cache's lock, so two threads making the same one at once both pay for it, but only one is kept.
+//The cache doesn't keep spectra alive: they go away with the last convolver using them, and take their entries with them.
+std::shared_ptr<ResponseSpectrum> getResponseSpectrum(int fftSize, int partitionSize, int length, const float* response);
+//How many spectra are alive, and how many bytes they hold between them.
+void getResponseSpectrumCacheUsage(int &count, long long &bytes);
+
+}
@@ -8,6 +8,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #pragma once
 #include <audio_io/audio_io.hpp>
 #include <powercores/threadsafe_queue.hpp>
+#include <powercores/bounded_queues.hpp>
 #include <functional> //we have to use an std::function for the preprocessing hook.  There's no good way around it because worlds need to use capturing lambdas.
 #include <set>
 #include <vector>
@@ -17,9 +18,12 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <tuple>
 #include <map>
 #include <random>
+#include <atomic>
 #include "../libaudioverse.h"
 #include "memory.hpp"
 #include "job.hpp"
+#include "audio_thread.hpp"
+#include "timer_wheel.hpp"
 
 namespace libaudioverse_implementation {
 
@@ -27,6 +31,39 @@ class Node;
 class Device;
 class InputConnection;
 class Planner;
+class Automator;
+class TopologyCommit;
+
+enum class PropertyCommandKinds {
+	SET, AUTOMATE, CANCEL_AUTOMATORS,
+};
+
+/**A property write or automation call from the public API, queued so that it needn't wait for the server's lock.
+See Server::setQueuePropertyWrites.*/
+class PropertyCommand {
+	public:
+	PropertyCommandKinds kind = PropertyCommandKinds::SET;
+	std::weak_ptr<Node> node;
+	int slot = 0;
+	//For SET, the property's type and its new value; ints are stored as doubles.
+	int type = 0;
+	double values[6] = {};
+	//For AUTOMATE, the automator to schedule.  We own it until it's scheduled.
+	Automator* automator = nullptr;
+	//For AUTOMATE and CANCEL_AUTOMATORS, the time from the call, in seconds.
+	double time = 0.0;
+	//The server's tick count when this was queued.
+	int tick = 0;
+};
+
+//A callback from scheduleCall, for the time it should run.
+class ScheduledCallback {
+	public:
+	double time = 0.0;
+	//Counts calls to scheduleCall, so that callbacks for the same time run in the order they were scheduled.
+	uint64_t sequence = 0;
+	std::function<void(void)> callback;
+};
 
 /*When thrown on the background thread, terminates it.*/
 class ThreadTerminationException {
@@ -78,9 +115,56 @@ class Server: public Job {
 	//Thread support.
 	void setThreads(int n);
 	int getThreads();
+	//While a block is running, which of our threads the caller is; see Planner::getCurrentWorker.
+	int getCurrentWorker();
+	//How our audio threads are set up.  See audio_thread.hpp.
+	void setSchedulingPolicy(int policy, int priority);
+	void setCpuAffinity(std::vector<int> cpus);
+	void setFlushDenormals(bool flush);
+	void setLockMemory(bool lock);
+	const AudioThreadConfiguration& getAudioThreadConfiguration();
+	//See Planner::getCriticalPathCost.
+	double getCriticalPathCost();
+	//Share transient buffers between nodes; see Planner::setBufferPooling.
+	void setBufferPooling(bool pooling);
+	//Needs the lock. Moves node's inputs into or out of the pool to match setBufferPooling, and grows the pool to fit them.
+	//Nodes call this whenever their inputs change, so that the audio thread never has to.
+	void updateBufferPooling(Node* node);
 
-	//called when connections are formed or lost, or when a node is deleted.
+	//Throws away the whole plan.
 	void invalidatePlan();
+	//Called when connections are formed or lost, or when a node is paused, unpaused, or deleted.
+	//These let the planner update only the part of the graph that changed; see planner.hpp.
+	void invalidateDependencies(Job* job);
+	void invalidateDependents(Job* job);
+	void invalidateDependenciesFromJob(Job* job);
+	//Connections are edited under this rather than our lock, so that graph edits and the audio thread never wait for each other.
+	//If you need both, take our lock first.
+	std::recursive_mutex& getTopologyMutex() {return topology_mutex;}
+	//Needs the topology mutex. Snapshots everything commit changed and publishes it for the start of the next block; we own it after this.
+	void commitTopology(TopologyCommit* commit);
+	//Needs the lock. getBlock calls this.
+	void applyTopologyCommits();
+	//Frees commits the audio thread is done with. Never called on the audio thread.
+	void freeRetiredTopologyCommits();
+	//If queueing is on, property writes and automation from the public API don't take our lock.
+	//They're validated as well as they can be without it, and applied at the start of the next block.
+	void setQueuePropertyWrites(bool queue);
+	bool getQueuePropertyWrites();
+	//Threadsafe. Returns false if the queue is full, in which case the caller should take the lock and do it directly.
+	bool enqueuePropertyCommand(const PropertyCommand &command);
+	//Needs the lock. getBlock calls this first; the public API calls it so that locked calls see earlier queued writes.
+	void applyPropertyCommands();
+	//Called from the background thread, to report what applyPropertyCommands couldn't apply.
+	void logDroppedPropertyCommands();
+	//Lock-free. Rendering threads hand dead objects here instead of destroying them; the background thread destroys them in batches.
+	void buryObject(ExternalObject* obj);
+	//Destroys everything buried so far. Never called on the audio thread.
+	void emptyGraveyard();
+	//Lock-free. Like buryObject, for things which aren't ExternalObjects; we own obj after this.
+	void retire(Retirable* obj);
+	//Deletes everything retired so far. Never called on the audio thread.
+	void freeRetired();
 	
 	//Get the time. This is relative to whenever the server was created, and advances with getBlock.
 	double getCurrentTime();
@@ -104,6 +188,10 @@ class Server: public Job {
 	protected:
 	//Schedule a call in when seconds.
 	void scheduleCall(double when, std::function<void(void)> func);
+	//Needs the lock. Puts it in the wheel, and makes sure getBlock has room for it.
+	void addScheduledCallback(uint64_t due, ScheduledCallback &&callback);
+	//Called from the background thread. Moves deferred_callbacks into the wheel.
+	void scheduleDeferredCallbacks();
 	
 	//the connection to which nodes connect themselves if their output should be audible.
 	std::shared_ptr<InputConnection> final_output_connection;
@@ -118,7 +206,9 @@ class Server: public Job {
 	std::set<std::weak_ptr<Node>, std::owner_less<std::weak_ptr<Node>>> always_playing_nodes; //Nodes that are currently always playing.
 	std::set<std::weak_ptr<Node>, std::owner_less<std::weak_ptr<Node>>> maintenance_nodes; //Nodes that need doMaintenance.
 	
-	std::recursive_mutex mutex;
+	std::recursive_mutex mutex, topology_mutex;
+	//Both newest first. Published commits are waiting for the audio thread, and retired ones are waiting to be freed.
+	std::atomic<TopologyCommit*> published_topology_commits{nullptr}, retired_topology_commits{nullptr};
 
 	powercores::ThreadsafeQueue<std::function<void(void)>>  tasks;
 	std::thread backgroundTaskThread;
@@ -127,7 +217,7 @@ class Server: public Job {
 	//our output, if any.
 	std::unique_ptr<audio_io::OutputDevice> output_device = nullptr;
 
-	int tick_count = 0; //counts ticks.  This is part of node processing.
+	std::atomic<int> tick_count{0}; //counts ticks.  This is part of node processing. Atomic because queued property commands are stamped with it.
 	int maintenance_start = 0; //also part of node processing. Used to stagger calls to doMaintenance on nodes so that we're not randomly spiking the tick length.
 	int maintenance_rate = 5; //call on every 5th object.
 
@@ -136,12 +226,38 @@ class Server: public Job {
 	LavTimeCallback block_callback = nullptr;
 	void* block_callback_userdata =nullptr;
 	double block_callback_set_time = 0.0;
-	std::multimap<double, std::function<void(void)>> scheduled_callbacks;
+	//Keyed by the tick after which the callback should run; the time is checked again when it comes out.
+	TimerWheel<ScheduledCallback> scheduled_callbacks;
+	//What came out of the wheel, plus anything rounding let out a block early.
+	//scheduleCall reserves room for everything scheduled, so getBlock never allocates here.
+	std::vector<ScheduledCallback> due_callbacks;
+	uint64_t scheduled_callback_count = 0;
+	/**Calls scheduled while rendering, which is usually callbacks rescheduling themselves, paired with the tick they're due after.
+	The wheel can allocate, so these wait here, in room reserved up front, until the background thread schedules them properly.
+	getBlock checks them in the meantime, so they aren't late.*/
+	std::vector<std::pair<uint64_t, ScheduledCallback>> deferred_callbacks;
+	std::atomic<bool> has_deferred_callbacks{false};
 	
 	Planner* planner = nullptr;
 	int threads = 1;
+	bool buffer_pooling = false;
+	//The most pooled buffers any node has asked for.
+	int buffer_pool_width = 0;
+	AudioThreadConfiguration audio_thread_configuration;
+	bool locked_memory = false;
+	std::atomic<bool> queue_property_writes{false};
+	//On the heap, like Planner::job_invalidations, so that Server isn't over-aligned.
+	powercores::MpmcQueue<PropertyCommand>* property_commands = nullptr;
+	//Queued commands which failed since the background thread last logged them, and the last failure. Needs the lock.
+	int dropped_property_commands = 0, last_dropped_property_slot = 0;
+	char last_dropped_property_message[128] = {};
+	std::atomic<bool> has_dropped_property_commands{false};
+	//Newest first, linked through graveyard_next.
+	std::atomic<ExternalObject*> graveyard{nullptr};
+	//Newest first, linked through retired_next.
+	std::atomic<Retirable*> retired{nullptr};
 	
-	template<typename JobT, typename CallableT, typename... ArgsT>
+	template<bool staged, typename JobT, typename CallableT, typename... ArgsT>
 	friend void serverVisitDependencies(JobT&& start, CallableT&& callable, ArgsT&&... args);
 };
 
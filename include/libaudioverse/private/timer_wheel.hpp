@@ -0,0 +1,164 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#pragma once
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace libaudioverse_implementation {
+
+/**A hierarchical timer wheel.
+
+Time is measured in ticks, which are whatever the user advances by; the server and buffer timelines use blocks.
+Scheduling is O(1), and advancing costs only the items that come due plus the occasional cascade of a coarser wheel into finer ones.
+
+Level 0 has a slot for each of the next slot_count ticks.  Each level after that has slots slot_count times as wide.
+Items which don't fit in any level go to an overflow list, which is reconsidered whenever the top level wraps.
+An item only ever moves down into the slots its due tick names at each level below where it starts, so schedule reserves room in all of them.
+Advancing therefore never allocates, and can be done on the audio thread; scheduling can allocate, so do it somewhere else.*/
+template<typename T>
+class TimerWheel {
+	public:
+	//Items due at or before the current tick come out on the next advance.
+	void schedule(uint64_t due, T item) {
+		//The slot for now has already fired.
+		if(due <= now) {
+			ready.push_back(Entry{due, -1, std::move(item)});
+			count++;
+			return;
+		}
+		int top = getLevel(due);
+		for(int l = 0; l <= top && l < level_count; l++) reserve(levels[l][getSlot(due, l)], ++path_counts[l][getSlot(due, l)]);
+		if(top == level_count) {
+			overflow_count++;
+			//Redistributing the overflow swaps it with scratch.
+			reserve(overflow, overflow_count);
+			reserve(scratch, overflow_count);
+		}
+		place(Entry{due, top, std::move(item)});
+		count++;
+	}
+
+	//Calls callable(item) for everything due at or before tick, then makes tick current.
+	//Callable must not schedule; collect and reschedule afterwords instead.
+	template<typename CallableT>
+	void advance(uint64_t tick, CallableT &&callable) {
+		if(count == 0) {
+			if(tick > now) now = tick;
+			return;
+		}
+		fire(ready, callable);
+		while(now < tick) {
+			now++;
+			if((now & slot_mask) == 0) cascade();
+			fire(levels[0][now & slot_mask], callable);
+		}
+	}
+
+	uint64_t getNow() {
+		return now;
+	}
+
+	//Number of scheduled items.
+	size_t size() {
+		return count;
+	}
+
+	template<typename CallableT>
+	void clear(CallableT &&callable) {
+		fire(ready, callable);
+		for(auto &l: levels) {
+			for(auto &s: l) fire(s, callable);
+		}
+		fire(overflow, callable);
+	}
+
+	private:
+	static const int slot_bits = 6, slot_count = 1<<slot_bits, level_count = 5;
+	static const uint64_t slot_mask = slot_count-1;
+
+	struct Entry {
+		uint64_t due;
+		//The level it was first placed at, or -1 for ready; it has room in due's slot at this level and every one below.
+		int top;
+		T item;
+	};
+
+	//The first level at which due and now share everything above the slot is the one whose slot due is in.
+	//level_count means the overflow.
+	int getLevel(uint64_t due) {
+		for(int l = 0; l < level_count; l++) {
+			int shift = slot_bits*(l+1);
+			if((due >> shift) == (now >> shift)) return l;
+		}
+		return level_count;
+	}
+
+	static int getSlot(uint64_t due, int level) {
+		return (due >> (slot_bits*level)) & slot_mask;
+	}
+
+	static void reserve(std::vector<Entry> &v, size_t needed) {
+		if(v.capacity() < needed) v.reserve(std::max(needed, 2*v.capacity()));
+	}
+
+	//Due must be at least now; cascading puts things due now into the slot that's about to fire.
+	void place(Entry &&e) {
+		int l = getLevel(e.due);
+		if(l == level_count) overflow.push_back(std::move(e));
+		else levels[l][getSlot(e.due, l)].push_back(std::move(e));
+	}
+
+	//Called when level 0 wraps. Moves the slot of each coarser level we just entered down a level, going up for as long as levels keep wrapping.
+	void cascade() {
+		for(int l = 1; l < level_count; l++) {
+			uint64_t slot = (now >> (slot_bits*l)) & slot_mask;
+			redistribute(levels[l][slot]);
+			if(slot != 0) return;
+		}
+		redistribute(overflow);
+	}
+
+	//Everything in a slot goes to a lower level, so that needs no scratch space.
+	//Only the overflow can put things back where they came from.
+	void redistribute(std::vector<Entry> &from) {
+		if(&from == &overflow) {
+			scratch.swap(overflow);
+			for(auto &e: scratch) place(std::move(e));
+			scratch.clear();
+		}
+		else {
+			for(auto &e: from) place(std::move(e));
+			from.clear();
+		}
+	}
+
+	template<typename CallableT>
+	void fire(std::vector<Entry> &from, CallableT &&callable) {
+		for(auto &e: from) {
+			//It's leaving, so it no longer needs its room.
+			for(int l = 0; l <= e.top && l < level_count; l++) path_counts[l][getSlot(e.due, l)]--;
+			if(e.top == level_count) overflow_count--;
+			callable(e.item);
+		}
+		count -= from.size();
+		from.clear();
+	}
+
+	std::vector<Entry> levels[level_count][slot_count];
+	std::vector<Entry> ready, overflow, scratch;
+	//How many scheduled items might pass through each slot, and the overflow; each has at least this much capacity.
+	size_t path_counts[level_count][slot_count] = {};
+	size_t overflow_count = 0;
+	uint64_t now = 0;
+	size_t count = 0;
+};
+
+}
@@ -46,6 +46,14 @@ enumerations:
       Lav_NODESTATE_PAUSED: This node is paused.
       Lav_NODESTATE_PLAYING: This node advances if other nodes need audio from it.
       Lav_NODESTATE_ALWAYS_PLAYING: This node advances always.
+  Lav_SCHEDULING_POLICIES:
+    doc_description: |
+      How the operating system should schedule threads that process audio.
+      See {{"Lav_serverSetSchedulingPolicy"|function}}.
+    members:
+      Lav_SCHEDULING_POLICY_NORMAL: Leave scheduling alone.
+      Lav_SCHEDULING_POLICY_FIFO: Realtime first-in first-out scheduling.  On Linux, this is SCHED_FIFO.
+      Lav_SCHEDULING_POLICY_ROUND_ROBIN: Realtime round-robin scheduling.  On Linux, this is SCHED_RR.
   Lav_LOGGING_LEVELS:
     doc_description: |
       Possible levels for logging.
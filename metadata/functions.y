@@ -259,6 +259,82 @@ functions:
     category: servers
     doc_description: |
       Get the number of threads that the server is currently using.
+  Lav_serverSetSchedulingPolicy:
+    category: servers
+    doc_description: |
+      Set how the operating system schedules the threads that process this server's audio.
+      This applies to the server's worker threads, to the thread which calls into the output device, and to any thread while it is inside {{"Lav_serverGetBlock"|function}}.
+      
+      Realtime policies usually need permission from the operating system.
+      On Linux, this means an rtprio limit; if the limit is missing, Libaudioverse logs the failure and continues with normal scheduling.
+      Only Linux supports this function.  Other platforms ignore it.
+    params:
+      policy: One of the {{"Lav_SCHEDULING_POLICIES"|enum}} enum.
+      priority: The realtime priority, from 1 to 99.  Ignored for {{"Lav_SCHEDULING_POLICY_NORMAL"|codelit}}.
+  Lav_serverSetCpuAffinity:
+    category: servers
+    doc_description: |
+      Pin the threads that process this server's audio to specific CPUs.
+      The thread which calls into the server gets the first CPU, and each worker thread gets the next, wrapping around if there are more threads than CPUs.
+      
+      Only Linux supports this function.  Other platforms ignore it.
+    params:
+      cpuCount: The number of CPUs.  0 stops pinning threads.
+      cpus: The indices of the CPUs to use.
+  Lav_serverSetFlushDenormals:
+    category: servers
+    doc_description: |
+      Set whether threads that process this server's audio treat denormal floating point numbers as zero.
+      Denormals are extremely slow on most processors and show up in the decaying tails of filters and reverbs, so this is on by default.
+    params:
+      flushDenormals: 1 to flush denormals to zero, 0 to leave them alone.
+  Lav_serverSetLockMemory:
+    category: servers
+    doc_description: |
+      Lock all of this process's memory into RAM, so that audio threads never wait for the operating system to page memory in.
+      This applies to the whole process, not only to this server.
+      Memory stays locked until every server which asked for it has unlocked it or been destroyed.
+      
+      On Linux, this can fail if RLIMIT_MEMLOCK is too low.
+      Other platforms ignore this function.
+    params:
+      lockMemory: 1 to lock memory, 0 to unlock it.
+  Lav_serverGetCriticalPathCost:
+    category: servers
+    doc_description: |
+      Get the estimated cost of the most expensive chain of nodes which must run one after another, in seconds per block.
+      This is the sum of the {{"Lav_nodeGetProcessingCost"|function}} values along that chain, and bounds how fast the server can go no matter how many threads it has.
+      The server uses this to decide what to run first.
+  Lav_serverSetBufferPooling:
+    category: servers
+    doc_description: |
+      Set whether nodes share the buffers they mix their inputs into.
+      
+      Normally, every node has its own input buffers.
+      Since these are only used while the node is processing, a server with buffer pooling enabled instead gives each thread one set of buffers which every node it runs uses in turn.
+      For large graphs, this saves memory and keeps more of what the server is working on in cache.
+      
+      This is off by default.
+    params:
+      pooling: 1 to share input buffers, 0 to give every node its own.
+  Lav_serverSetQueuePropertyWrites:
+    category: servers
+    doc_description: |
+      Set whether property writes and automation skip the server's lock.
+      
+      Normally, setting a property waits for the server's lock, which the audio thread holds for the whole of every block.
+      With queueing enabled, {{"Lav_nodeSetIntProperty"|function}}, {{"Lav_nodeSetFloatProperty"|function}}, {{"Lav_nodeSetDoubleProperty"|function}}, {{"Lav_nodeSetFloat3Property"|function}}, {{"Lav_nodeSetFloat6Property"|function}} and the automation functions instead put the change on a queue and return immediately.
+      The server applies everything on the queue at the start of the next block, in the order it was queued.
+      Automation is scheduled relative to when the call was made, not when the server gets to it.
+      
+      Types, read-only properties and ranges are still checked immediately.
+      Errors which can only be detected later, such as overlapping automators, are logged and the change is dropped.
+      Writes to properties whose range can change, and writes made while the queue is full, take the lock as usual.
+      Any call which takes the lock and touches properties applies the queue first, so reading a property always sees your earlier writes.
+      
+      This is off by default.
+    params:
+      queue: 1 to queue property writes, 0 to apply them under the lock.
   Lav_serverCallIn:
     category: servers
     doc_description: |
@@ -604,4 +680,10 @@ functions:
     doc_description: |
       Reset a node.
       What this means depends on the node in question.
-      Properties are not touched by node resetting.
\ No newline at end of file
+      Properties are not touched by node resetting.
+  Lav_nodeGetProcessingCost:
+    category: nodes
+    doc_description: |
+      Get how long this node takes to process a block, in seconds.
+      This is a moving average measured by the server as it runs, and is 0 until the node has been processed at least once.
+      Together, these make up a table of where the server spends its time.
\ No newline at end of file
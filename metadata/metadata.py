@@ -126,10 +126,18 @@ for propkey, propid, propinfo in joined_properties:
 joined_properties.sort()
 joined_events.sort()
 
+#Each node type stores its properties in a dense array, so we lay them out here.
+#Slots go in descending order (-1, -2, ...) so that the layout is the same from build to build.
+property_layouts = dict()
+for objid, propid, propinfo in joined_properties:
+    property_layouts.setdefault(objid, set()).add(propid)
+property_layouts = sorted((objid, sorted(propids, key = lambda i: -all_info['constants'][i])) for objid, propids in property_layouts.items())
+
 #do the render, and write to the file specified on the command line.
 context = {
 'joined_properties': joined_properties,
 'joined_events': joined_events,
+'property_layouts': property_layouts,
 }
 context.update(all_info)
 
@@ -18,6 +18,8 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <map>
 #include <string>
 #include <set>
+#include <vector>
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 //these three macros make ranges work.
@@ -38,10 +40,13 @@ namespace libaudioverse_implementation {
 //We're intensionally avoiding any ambiguity with static constructors by allocating these at library initialization.
 //we're also leaning heavily on the default copy constructor of properties, which is safe for the moment.
 std::map<std::tuple<int, int>, Property> *default_property_instances = nullptr;
-std::map<int, std::set<int>> *properties_by_node_type;
+std::map<int, PropertyLayout> *property_layouts = nullptr;
+//For node types without any properties.
+PropertyLayout *empty_property_layout = nullptr;
 
 void initializeMetadata() {
-	properties_by_node_type = new std::map<int, std::set<int>>();
+	property_layouts = new std::map<int, PropertyLayout>();
+	empty_property_layout = new PropertyLayout();
 	default_property_instances = new std::map<std::tuple<int, int>, Property>();
 	Property* tempProp= nullptr; //a temporary that we use a bunch of times.
 	{%for objid, propid, prop in joined_properties%}
@@ -77,17 +82,35 @@ void initializeMetadata() {
 	{#Use the copy constructor to put this into the default instances#}
 	(*default_property_instances)[std::tuple<int, int>(<%objid%>, <%propid%>)] = *tempProp;
 	delete tempProp;
-	(*properties_by_node_type)[<%objid%>].insert(<%propid%>);
 	}
 	{%endfor%}
+	{%for objid, propids in property_layouts%}
+	(*property_layouts)[<%objid%>].setSlots({<%propids|join(', ')%>});
+	{%endfor%}
+}
+
+void PropertyLayout::setSlots(std::vector<int> s) {
+	slots = s;
+	int largest = 0;
+	for(auto slot: slots) largest = std::max(largest, -slot);
+	indices.clear();
+	indices.resize(largest+1, -1);
+	for(int i = 0; i < (int)slots.size(); i++) indices[-slots[i]] = i;
 }
 
+const PropertyLayout* getPropertyLayout(int nodetype) {
+	auto i = property_layouts->find(nodetype);
+	if(i == property_layouts->end()) return empty_property_layout;
+	return &i->second;
+}
 
-std::map<int, Property> makePropertyTable(int nodetype) {
-	auto needed = (*properties_by_node_type)[nodetype];
-	std::map<int, Property> retval;
-	for(auto index: needed) {
-		retval[index] = (*default_property_instances)[std::tuple<int, int>(nodetype, index)];
+std::vector<Property> makePropertyArray(int nodetype) {
+	auto layout = getPropertyLayout(nodetype);
+	std::vector<Property> retval;
+	retval.reserve(layout->getCount());
+	for(auto slot: layout->getSlots()) {
+		retval.push_back((*default_property_instances)[std::tuple<int, int>(nodetype, slot)]);
+		retval.back().setTag(slot);
 	}
 	return retval;
 }
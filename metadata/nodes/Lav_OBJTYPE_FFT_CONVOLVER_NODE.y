@@ -1,3 +1,14 @@
+properties:
+  Lav_FFT_CONVOLVER_CROSSFADE_TIME:
+    name: crossfade_time
+    type: float
+    default: 0.0
+    range: [0.0, INFINITY]
+    doc_description: |
+      When a response loaded from a file is ready, the node crossfades from the old response to the new one over this many seconds.
+      At 0, the new response replaces the old one at the start of the next block.
+      
+      Responses set directly with {{"Lav_fftConvolverNodeSetResponse"|extra_function}} always replace the old one immediately.
 extra_functions:
   Lav_fftConvolverNodeSetResponse:
     doc_description: |
@@ -9,6 +20,10 @@ extra_functions:
   Lav_fftConvolverNodeSetResponseFromFile:
     doc_description: |
       Set the impulse response for a specific channel of this node from a file.
+      
+      The file is checked before this function returns, but reading, resampling, and preparing it happen in the background.
+      Until that's done, the channel keeps its old response; then it changes at the start of a block, crossfading if {{"Lav_FFT_CONVOLVER_CROSSFADE_TIME"|property}} is set.
+      If the response for the channel is set again before then, this load is thrown away.
     params:
       path: The path to the file.
       fileChannel: The channel of the file to use as the response.
@@ -21,10 +36,14 @@ doc_name: fft convolver
 doc_description: |
   A convolver for long impulse responses.
   
-  This convolver uses the overlap-add convolution algorithm.
+  This convolver splits the response into pieces which double in size, and does all but the first block of the response on background threads.
+  The work done on the audio thread stays small no matter how long the response is, and there is no added latency.
   It is slower than the {{"Lav_OBJTYPE_CONVOLVER_NODE"|node}} for small impulse responses.
   
   The difference between this node and the {{"Lav_OBJTYPE_CONVOLVER_NODE"|node}} is the complexity of the algorithm.
   This node is capable of handling impulses longer than a second, a case for which the {{"Lav_OBJTYPE_CONVOLVER_NODE"|node}} will fail to run in realtime.
   
-  Furthermore, as the most common operation for this node is reverb, it is possible to set each channel's response separately.
\ No newline at end of file
+  Furthermore, as the most common operation for this node is reverb, it is possible to set each channel's response separately.
+  
+  Channels and nodes given exactly the same response share one copy of its transformed form.
+  Only the first pays to compute it, so giving many nodes the same long response is cheap.
\ No newline at end of file
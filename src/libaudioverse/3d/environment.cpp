@@ -13,6 +13,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/server.hpp>
 #include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <libaudioverse/private/hrtf.hpp>
 #include <libaudioverse/private/buffer.hpp>
 #include <libaudioverse/private/helper_templates.hpp>
@@ -34,8 +35,7 @@ EnvironmentNode::EnvironmentNode(std::shared_ptr<Server> server, std::shared_ptr
 	this->hrtf = hrtf;
 	int channels = getProperty(Lav_ENVIRONMENT_OUTPUT_CHANNELS).getIntValue();
 	appendOutputConnection(0, channels);
-	//Allocate the 8 internal buffers.
-	for(int i = 0; i < 8; i++) source_buffers.push_back(allocArray<float>(server->getBlockSize()));
+	threadsChanged(server->getThreads());
 	updateEnvironmentInfo(true);
 	setShouldZeroOutputBuffers(false);
 }
@@ -47,7 +47,23 @@ std::shared_ptr<EnvironmentNode> createEnvironmentNode(std::shared_ptr<Server> s
 }
 
 EnvironmentNode::~EnvironmentNode() {
-	for(auto p: source_buffers) freeArray(p);
+	for(auto &b: buses) {
+		for(auto p: b) freeArray(p);
+	}
+}
+
+void EnvironmentNode::addBus() {
+	std::vector<float*> bus;
+	for(int i = 0; i < bus_channels; i++) bus.push_back(allocArray<float>(server->getBlockSize()));
+	buses.push_back(bus);
+	bus_used.push_back(0);
+	used_buses.reserve(buses.size());
+}
+
+float** EnvironmentNode::getBus() {
+	int worker = server->getCurrentWorker();
+	bus_used[worker] = 1;
+	return &buses[worker][0];
 }
 
 void EnvironmentNode::willTick() {
@@ -61,11 +77,41 @@ void EnvironmentNode::willTick() {
 	filterWeakPointers(sources, [&](std::shared_ptr<SourceNode> &s) {
 		s->update(environment_info);
 	});
-	for(auto p: source_buffers) std::fill(p, p+block_size, 0.0f);
+	//Only buses which were written need clearing.
+	for(int i = 0; i < buses.size(); i++) {
+		if(bus_used[i] == 0) continue;
+		for(auto p: buses[i]) std::fill(p, p+block_size, 0.0f);
+		bus_used[i] = 0;
+	}
+}
+
+void EnvironmentNode::threadsChanged(int threads) {
+	//The planner might use every thread, and there's no growing these while it runs.
+	while(buses.size() < threads) addBus();
 }
 
 void EnvironmentNode::process() {
-	for(int i = 0; i < source_buffers.size(); i++) std::copy(source_buffers[i], source_buffers[i]+block_size, output_buffers[i]);
+	auto &used = used_buses;
+	used.clear();
+	for(int i = 0; i < buses.size(); i++) {
+		if(bus_used[i]) used.push_back(i);
+	}
+	int usedCount = used.size();
+	if(usedCount == 0) {
+		for(int i = 0; i < bus_channels; i++) std::fill(output_buffers[i], output_buffers[i]+block_size, 0.0f);
+		markSilent();
+		return;
+	}
+	//Sum pairwise, so that each bus is only read once per level and the sums stay balanced.
+	for(int stride = 1; stride < usedCount; stride *= 2) {
+		for(int i = 0; i+stride < usedCount; i += 2*stride) {
+			auto &a = buses[used[i]];
+			auto &b = buses[used[i+stride]];
+			for(int j = 0; j < bus_channels; j++) additionKernel(block_size, a[j], b[j], a[j]);
+		}
+	}
+	auto &sum = buses[used[0]];
+	for(int i = 0; i < bus_channels; i++) std::copy(sum[i], sum[i]+block_size, output_buffers[i]);
 }
 
 void EnvironmentNode::updateEnvironmentInfo(bool force) {
@@ -111,13 +157,18 @@ std::shared_ptr<HrtfData> EnvironmentNode::getHrtf() {
 
 void EnvironmentNode::registerSourceForUpdates(std::shared_ptr<SourceNode> source, bool useEffectSends) {
 	sources.insert(source);
+	{
+		LOCK(server->getTopologyMutex());
+		killDeadWeakPointers(staged_sources);
+		staged_sources.insert(source);
+	}
 	if(useEffectSends) {
 		for(int i = 0; i < effect_sends.size(); i++) {
 			if(effect_sends[i].connect_by_default) source->feedEffect(i);
 		}
 	}
 	//Sources count as dependencies, so we need to invalidate.
-	server->invalidatePlan();
+	server->invalidateDependencies(this);
 }
 
 void EnvironmentNode::playAsync(std::shared_ptr<Buffer> buffer, float x, float y, float z, bool isDry) {
@@ -189,15 +240,18 @@ int EnvironmentNode::addEffectSend(int channels, bool isReverb, bool connectByDe
 	ERROR(Lav_ERROR_RANGE, "Reverb effects sends must have 4 channels.");
 	EffectSendConfiguration send;
 	send.channels = channels;
-	send.start = (int)source_buffers.size();
+	send.start = bus_channels;
 	send.is_reverb = isReverb;
 	send.connect_by_default = connectByDefault;
 	//Resize the output gain node to have room, and append new connections.
-	int oldSize = source_buffers.size();
+	int oldSize = bus_channels;
 	int newSize = oldSize+send.channels;
 	resize(0, newSize);
 	appendOutputConnection(oldSize, send.channels);
-	for(int i = 0; i < send.channels; i++) source_buffers.push_back(allocArray<float>(server->getBlockSize()));
+	for(auto &b: buses) {
+		for(int i = 0; i < send.channels; i++) b.push_back(allocArray<float>(server->getBlockSize()));
+	}
+	bus_channels = newSize;
 	int index = effect_sends.size();
 	effect_sends.push_back(send);
 	for(auto &i: sources) {
@@ -198,15 +198,16 @@ void SourceNode::process() {
 		channels = 8;
 		break;
 	}
-	for(int i = 0; i < channels; i++) if(panBuffers[i]) multiplicationAdditionKernel(block_size, dry_gain, panBuffers[i], environment->source_buffers[i], environment->source_buffers[i]);
+	float** bus = environment->getBus();
+	for(int i = 0; i < channels; i++) if(panBuffers[i]) multiplicationAdditionKernel(block_size, dry_gain, panBuffers[i], bus[i], bus[i]);
 	for(auto &s: fed_effects) {
 		auto &send = environment->getEffectSend(s.first);
 		auto &p = s.second;
 		float g = send.is_reverb ? reverb_gain : dry_gain;
-		if(send.channels == 1) multiplicationAdditionKernel(block_size, g, occluded, environment->source_buffers[send.start], environment->source_buffers[send.start]);
+		if(send.channels == 1) multiplicationAdditionKernel(block_size, g, occluded, bus[send.start], bus[send.start]);
 		else {
 			p->pan(occluded, panBuffers);
-			for(int i = 0; i < send.channels; i++) multiplicationAdditionKernel(block_size, g, panBuffers[i], environment->source_buffers[send.start+i], environment->source_buffers[send.start+i]);
+			for(int i = 0; i < send.channels; i++) multiplicationAdditionKernel(block_size, g, panBuffers[i], bus[send.start+i], bus[send.start+i]);
 		}
 	}
 }
@@ -7,35 +7,203 @@ https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 o
 carrying such notice may not be copied, modified, or distributed except according to those terms. */
 #include <libaudioverse/private/audio_thread.hpp>
 #include <libaudioverse/private/logging.hpp>
-
-namespace libaudioverse_implementation {
+#include <atomic>
+#include <mutex>
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+#include <xmmintrin.h>
+#endif
 #if defined(LIBAUDIOVERSE_IS_WINDOWS)
 #include <windows.h>
 #include <avrt.h>
+#elif defined(LIBAUDIOVERSE_IS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <string.h>
+#include <errno.h>
+#endif
+
+namespace libaudioverse_implementation {
+
+std::atomic<unsigned int> next_configuration_generation{1};
 
-//AvSetMmThreadCharacteristics returns 0 on failure.
-thread_local HANDLE task = 0;
-void becomeAudioThread() {
-	if(task) return; //We are already one.  This can sometimes happen.
+void AudioThreadConfiguration::markChanged() {
+	generation = next_configuration_generation.fetch_add(1);
+}
+
+//What we did to this thread, so we can undo it.
+class AudioThreadState {
+	public:
+	bool is_audio_thread = false, dedicated = false;
+	unsigned int generation = 0;
+	unsigned int old_csr = 0;
+	#if defined(LIBAUDIOVERSE_IS_WINDOWS)
+	HANDLE task = 0;
+	#elif defined(LIBAUDIOVERSE_IS_LINUX)
+	int old_policy = SCHED_OTHER;
+	sched_param old_param;
+	cpu_set_t old_cpus;
+	bool changed_scheduling = false, changed_affinity = false;
+	#endif
+};
+
+thread_local AudioThreadState thread_state;
+thread_local int rendering_depth = 0;
+
+RenderingScope::RenderingScope() {
+	rendering_depth++;
+}
+
+RenderingScope::~RenderingScope() {
+	rendering_depth--;
+}
+
+bool isRenderingThread() {
+	return rendering_depth > 0;
+}
+
+//Flush-to-zero and denormals-are-zero are bits 15 and 6 of MXCSR.
+const unsigned int denormal_bits = 0x8040;
+
+void setDenormalFlushing(bool flush) {
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	unsigned int csr = _mm_getcsr();
+	_mm_setcsr(flush ? csr|denormal_bits : csr&~denormal_bits);
+	#endif
+}
+
+#if defined(LIBAUDIOVERSE_IS_WINDOWS)
+
+void applyPlatformConfiguration(const AudioThreadConfiguration &config, int worker) {
+	auto &s = thread_state;
+	if(s.task) return; //We are already one.  This can sometimes happen.
 	DWORD unused = 0;
 	//yes this string is magic. See the MMCSS docs on MSDN.
-	task = AvSetMmThreadCharacteristics("Pro Audio", &unused);
-	if(task == 0) logDebug("Failed to make a thread a pro audio thread using MMCSS.");
+	s.task = AvSetMmThreadCharacteristics("Pro Audio", &unused);
+	if(s.task == 0) logDebug("Failed to make a thread a pro audio thread using MMCSS.");
 }
 
-void unbecomeAudioThread() {
-	if(task) {
-		AvRevertMmThreadCharacteristics(task);
-		if(task == 0) logDebug("Failed to revert an MMCSS thread.");
-		task = 0; //So that we aren't one anymore.
+void revertPlatformConfiguration() {
+	auto &s = thread_state;
+	if(s.task) {
+		AvRevertMmThreadCharacteristics(s.task);
+		if(s.task == 0) logDebug("Failed to revert an MMCSS thread.");
+		s.task = 0; //So that we aren't one anymore.
+	}
+}
+
+bool platformLockProcessMemory(bool lock) {
+	//Not supported here, so there's nothing to fail.
+	return true;
+}
+
+#elif defined(LIBAUDIOVERSE_IS_LINUX)
+
+void applyPlatformConfiguration(const AudioThreadConfiguration &config, int worker) {
+	auto &s = thread_state;
+	auto self = pthread_self();
+	if(s.is_audio_thread == false) {
+		pthread_getschedparam(self, &s.old_policy, &s.old_param);
+		pthread_getaffinity_np(self, sizeof(s.old_cpus), &s.old_cpus);
+	}
+	if(config.scheduling_policy != Lav_SCHEDULING_POLICY_NORMAL) {
+		int policy = config.scheduling_policy == Lav_SCHEDULING_POLICY_FIFO ? SCHED_FIFO : SCHED_RR;
+		sched_param param;
+		param.sched_priority = config.priority;
+		int err = pthread_setschedparam(self, policy, &param);
+		//Usually EPERM, because the user doesn't have an rtprio limit.
+		if(err) logDebug("Could not set realtime scheduling for an audio thread: %s", strerror(err));
+		else s.changed_scheduling = true;
+	}
+	else if(s.changed_scheduling) {
+		pthread_setschedparam(self, s.old_policy, &s.old_param);
+		s.changed_scheduling = false;
 	}
+	if(config.cpus.empty() == false) {
+		int cpu = config.cpus[worker%config.cpus.size()];
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		if(cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+		int err = pthread_setaffinity_np(self, sizeof(cpus), &cpus);
+		if(err) logDebug("Could not pin an audio thread to CPU %i: %s", cpu, strerror(err));
+		else s.changed_affinity = true;
+	}
+	else if(s.changed_affinity) {
+		pthread_setaffinity_np(self, sizeof(s.old_cpus), &s.old_cpus);
+		s.changed_affinity = false;
+	}
+}
+
+void revertPlatformConfiguration() {
+	auto &s = thread_state;
+	auto self = pthread_self();
+	if(s.changed_scheduling) pthread_setschedparam(self, s.old_policy, &s.old_param);
+	if(s.changed_affinity) pthread_setaffinity_np(self, sizeof(s.old_cpus), &s.old_cpus);
+	s.changed_scheduling = false;
+	s.changed_affinity = false;
+}
+
+bool platformLockProcessMemory(bool lock) {
+	//MCL_FUTURE covers everything allocated afterwords, including the buffers of nodes that don't exist yet.
+	int err = lock ? mlockall(MCL_CURRENT|MCL_FUTURE) : munlockall();
+	if(err) logDebug("Could not %s memory: %s", lock ? "lock" : "unlock", strerror(errno));
+	return err == 0;
 }
 
 #else
-void becomeAudioThread() {
+
+void applyPlatformConfiguration(const AudioThreadConfiguration &config, int worker) {
 }
 
-void unbecomeAudioThread() {
+void revertPlatformConfiguration() {
+}
+
+bool platformLockProcessMemory(bool lock) {
+	//Not supported here, so there's nothing to fail.
+	return true;
 }
+
 #endif
-}
\ No newline at end of file
+
+//Locking memory is process-wide but servers ask for it separately, so it stays locked until the last one lets go.
+std::mutex memory_lock_mutex;
+int memory_lock_count = 0;
+
+bool lockProcessMemory(bool lock) {
+	std::lock_guard<std::mutex> guard(memory_lock_mutex);
+	if(lock) {
+		if(memory_lock_count == 0 && platformLockProcessMemory(true) == false) return false;
+		memory_lock_count++;
+	}
+	else if(memory_lock_count > 0) {
+		if(memory_lock_count == 1 && platformLockProcessMemory(false) == false) return false;
+		memory_lock_count--;
+	}
+	return true;
+}
+
+void becomeAudioThread(const AudioThreadConfiguration &config, int worker, bool dedicated) {
+	auto &s = thread_state;
+	if(dedicated) s.dedicated = true;
+	if(s.is_audio_thread && s.generation == config.generation) return;
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	if(s.is_audio_thread == false) s.old_csr = _mm_getcsr();
+	#endif
+	applyPlatformConfiguration(config, worker);
+	setDenormalFlushing(config.flush_denormals);
+	s.is_audio_thread = true;
+	s.generation = config.generation;
+}
+
+void unbecomeAudioThread() {
+	auto &s = thread_state;
+	//We are potentially sharing this thread with someone else. It is important that we don't accidentally give them high priority too.
+	if(s.is_audio_thread == false || s.dedicated) return;
+	revertPlatformConfiguration();
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	_mm_setcsr((_mm_getcsr()&~denormal_bits)|(s.old_csr&denormal_bits));
+	#endif
+	s.is_audio_thread = false;
+}
+
+}
@@ -9,8 +9,10 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/automators.hpp>
 #include <libaudioverse/private/properties.hpp>
 #include <libaudioverse/private/node.hpp>
+#include <libaudioverse/private/server.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/macros.hpp>
+#include <math.h>
 
 namespace libaudioverse_implementation {
 
@@ -25,6 +27,10 @@ void Automator::start(double initialValue, double initialTime) {
 	initial_time = initialTime;
 }
 
+void Automator::renderBlock(double time, double sr, int first, int count, double* destination) {
+	for(int i = first; i < first+count; i++) destination[i] = getValue(time+i/sr);
+}
+
 double Automator::getDuration() {
 	return duration;
 }
@@ -33,15 +39,74 @@ double Automator::getScheduledTime() {
 	return scheduled_time;
 }
 
+void Automator::setScheduledTime(double t) {
+	scheduled_time = t;
+}
+
+void Automator::setProperty(Property* p) {
+	property = p;
+}
+
 bool compareAutomators(Automator *a, Automator *b) {
 	return a->getScheduledTime() < b->getScheduledTime();
 }
 
+int firstSampleAtOrAfter(double boundary, double time, double sr, int first, int last) {
+	double guess = ceil((boundary-time)*sr);
+	int i;
+	if(guess <= first) i = first;
+	else if(guess >= last) i = last;
+	else i = (int)guess;
+	//Rounding can put the guess one off either way.
+	while(i > first && time+(i-1)/sr >= boundary) i--;
+	while(i < last && time+i/sr < boundary) i++;
+	return i;
+}
+
+bool queueAutomator(std::shared_ptr<Node> node, int slot, double time, Automator* automator) {
+	auto server = node->getServer();
+	//Without the lock, only the snapshot is safe to look at.
+	auto info = node->getPropertySlotInfo(slot);
+	int type = info ? info->type : 0;
+	//Let the locked path report bad slots, and that only floats and doubles can be automated.
+	if(server->getQueuePropertyWrites() && (type == Lav_PROPERTYTYPE_FLOAT || type == Lav_PROPERTYTYPE_DOUBLE)) {
+		//Scheduling it happens on the audio thread, so make what that would allocate now.
+		//This is the only part which needs the lock, and it's quick.
+		{
+			LOCK(*server);
+			node->getProperty(slot).reserveAutomator();
+		}
+		PropertyCommand command;
+		command.kind = PropertyCommandKinds::AUTOMATE;
+		command.node = node;
+		command.slot = slot;
+		command.automator = automator;
+		command.time = time;
+		command.tick = server->getTickCount();
+		if(server->enqueuePropertyCommand(command)) return true;
+	}
+	delete automator;
+	return false;
+}
+
 Lav_PUBLIC_FUNCTION LavError Lav_automationCancelAutomators(LavHandle nodeHandle, int slot, double time) {
 	PUB_BEGIN
 	if(time < 0.0) ERROR(Lav_ERROR_RANGE, "Time must be positive or zero.");
 	auto n = incomingObject<Node>(nodeHandle);
+	auto server = n->getServer();
+	auto info = n->getPropertySlotInfo(slot);
+	int type = info ? info->type : 0;
+	if(server->getQueuePropertyWrites() && (type == Lav_PROPERTYTYPE_FLOAT || type == Lav_PROPERTYTYPE_DOUBLE)) {
+		PropertyCommand command;
+		command.kind = PropertyCommandKinds::CANCEL_AUTOMATORS;
+		command.node = n;
+		command.slot = slot;
+		command.time = time;
+		command.tick = server->getTickCount();
+		if(server->enqueuePropertyCommand(command)) return Lav_ERROR_NONE;
+	}
 	LOCK(*n);
+	server->applyPropertyCommands();
 	auto &prop = n->getProperty(slot);
 	prop.cancelAutomators(time);
 	PUB_END
@@ -10,6 +10,8 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/node.hpp>
+#include <libaudioverse/private/server.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <algorithm>
 
 namespace libaudioverse_implementation {
@@ -18,6 +20,7 @@ class EnvelopeAutomator: public Automator {
 	public:
 	EnvelopeAutomator(Property* p, double scheduledTime, double duration, int points, double* values);
 	virtual double  getValue(double time) override;
+	virtual void renderBlock(double time, double sr, int first, int count, double* destination) override;
 	virtual double getFinalValue();
 	double* envelope = nullptr;
 	int points=0;
@@ -51,6 +54,26 @@ double EnvelopeAutomator::getValue(double time) {
 	return envelope[p1]*w1+envelope[p2]*w2;
 }
 
+void EnvelopeAutomator::renderBlock(double time, double sr, int first, int count, double* destination) {
+	int end = first+count;
+	int i = firstSampleAtOrAfter(scheduled_time, time, sr, first, end);
+	std::fill(destination+first, destination+i, initial_value);
+	//The intervals are all the same length, so we can find the one we're in directly and then render the rest of it as a ramp.
+	while(i < end) {
+		double delta = time+i/sr-scheduled_time;
+		int p1 = (int)((delta/duration)*(points-1));
+		if(p1 >= points-1) {
+			std::fill(destination+i, destination+end, envelope[points-1]);
+			break;
+		}
+		int next = firstSampleAtOrAfter(scheduled_time+interval_duration*(p1+1), time, sr, i+1, end);
+		double slope = (envelope[p1+1]-envelope[p1])/interval_duration;
+		if(slope == 0.0) std::fill(destination+i, destination+next, envelope[p1]);
+		else rampKernel(next-i, envelope[p1]+(delta-interval_duration*p1)*slope, slope/sr, destination+i);
+		i = next;
+	}
+}
+
 double EnvelopeAutomator::getFinalValue() {
 	return envelope[points-1];
 }
@@ -64,7 +87,13 @@ Lav_PUBLIC_FUNCTION LavError Lav_automationEnvelope(LavHandle nodeHandle, int sl
 	if(values == nullptr) ERROR(Lav_ERROR_RANGE, "Values cannot be null.");
 	if(duration <= 0.0) ERROR(Lav_ERROR_RANGE, "Duration must be positive.");
 	auto node = incomingObject<Node>(nodeHandle);
+	if(node->getServer()->getQueuePropertyWrites()) {
+		//Resolving the property needs the lock, so applying the command fills it in.
+		auto automator = new EnvelopeAutomator(nullptr, 0.0, duration, valuesLength, values);
+		if(queueAutomator(node, slot, time, automator)) return Lav_ERROR_NONE;
+	}
 	LOCK(*node);
+	node->getServer()->applyPropertyCommands();
 	auto &prop= node->getProperty(slot);
 	EnvelopeAutomator* automator = new EnvelopeAutomator(&prop, prop.getTime()+time, duration, valuesLength, values);
 	//the property will throw for us if any part of the next part goes wrong.
@@ -10,6 +10,8 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/node.hpp>
+#include <libaudioverse/private/server.hpp>
+#include <libaudioverse/private/kernels.hpp>
 
 namespace libaudioverse_implementation {
 
@@ -18,6 +20,7 @@ class LinearRampAutomator: public Automator {
 	LinearRampAutomator(Property* p, double scheduledTime, double finalValue);
 	virtual void start(double initialTime, double initialValue) override;
 	virtual double  getValue(double time) override;
+	virtual void renderBlock(double time, double sr, int first, int count, double* destination) override;
 	virtual double getFinalValue();
 	double delta, final_value;
 };
@@ -34,6 +37,10 @@ double LinearRampAutomator::getValue(double time) {
 	return initial_value+(time-initial_time)*delta;
 }
 
+void LinearRampAutomator::renderBlock(double time, double sr, int first, int count, double* destination) {
+	rampKernel(count, getValue(time+first/sr), delta/sr, destination+first);
+}
+
 double LinearRampAutomator::getFinalValue() {
 	return final_value;
 }
@@ -43,7 +50,13 @@ double LinearRampAutomator::getFinalValue() {
 Lav_PUBLIC_FUNCTION LavError Lav_automationLinearRampToValue(LavHandle nodeHandle, int slot, double time, double value) {
 	PUB_BEGIN
 	auto node = incomingObject<Node>(nodeHandle);
+	if(node->getServer()->getQueuePropertyWrites()) {
+		//Resolving the property needs the lock, so applying the command fills it in.
+		auto automator = new LinearRampAutomator(nullptr, 0.0, value);
+		if(queueAutomator(node, slot, time, automator)) return Lav_ERROR_NONE;
+	}
 	LOCK(*node);
+	node->getServer()->applyPropertyCommands();
 	auto &prop= node->getProperty(slot);
 	LinearRampAutomator* automator = new LinearRampAutomator(&prop, prop.getTime()+time, value);
 	//the property will throw for us if any part of the next part goes wrong.
@@ -10,6 +10,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/node.hpp>
+#include <libaudioverse/private/server.hpp>
 #include <algorithm>
 
 namespace libaudioverse_implementation {
@@ -18,6 +19,7 @@ class SetAutomator: public Automator {
 	public:
 	SetAutomator(Property* p, double scheduledTime, double value);
 	virtual double  getValue(double time) override;
+	virtual void renderBlock(double time, double sr, int first, int count, double* destination) override;
 	virtual double getFinalValue() override;
 	double setting_to;
 };
@@ -30,6 +32,12 @@ double SetAutomator::getValue(double time) {
 	else return setting_to;
 }
 
+void SetAutomator::renderBlock(double time, double sr, int first, int count, double* destination) {
+	int switchesAt = firstSampleAtOrAfter(scheduled_time, time, sr, first, first+count);
+	std::fill(destination+first, destination+switchesAt, initial_value);
+	std::fill(destination+switchesAt, destination+first+count, setting_to);
+}
+
 double SetAutomator::getFinalValue() {
 	return setting_to;
 }
@@ -40,7 +48,13 @@ Lav_PUBLIC_FUNCTION LavError Lav_automationSet(LavHandle nodeHandle, int slot, d
 	PUB_BEGIN
 	if(time < 0.0) ERROR(Lav_ERROR_RANGE, "Time must be positive or 0.");
 	auto node = incomingObject<Node>(nodeHandle);
+	if(node->getServer()->getQueuePropertyWrites()) {
+		//Resolving the property needs the lock, so applying the command fills it in.
+		auto automator = new SetAutomator(nullptr, 0.0, value);
+		if(queueAutomator(node, slot, time, automator)) return Lav_ERROR_NONE;
+	}
 	LOCK(*node);
+	node->getServer()->applyPropertyCommands();
 	auto &prop= node->getProperty(slot);
 	SetAutomator* automator = new SetAutomator(&prop, prop.getTime()+time, value);
 	//the property will throw for us if any part of the next part goes wrong.
@@ -0,0 +1,127 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#include <libaudioverse/private/background_jobs.hpp>
+#include <libaudioverse/private/audio_thread.hpp>
+#include <libaudioverse/private/logging.hpp>
+#include <powercores/bounded_queues.hpp>
+#include <powercores/utilities.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libaudioverse_implementation {
+
+const int job_finished = 0, job_queued = 1, job_running = 2;
+
+//Workers sleep at most this long, so a wakeup lost to the unlocked notify costs at most this much.
+const int background_job_poll_interval = 1;
+
+std::vector<powercores::MpmcQueue<BackgroundJob*>*> background_job_queues;
+std::vector<std::thread> background_job_threads;
+std::atomic<int> pending_background_jobs{0};
+std::atomic<bool> background_jobs_running{false};
+std::mutex background_job_mutex;
+std::condition_variable background_job_wakeup;
+
+bool dequeueBackgroundJob(BackgroundJob* &job) {
+	for(auto q: background_job_queues) {
+		if(q->dequeue(job)) {
+			pending_background_jobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void BackgroundJob::submit(int priority) {
+	references.fetch_add(1, std::memory_order_relaxed);
+	state.store(job_queued, std::memory_order_release);
+	bool running = background_jobs_running.load(std::memory_order_acquire);
+	if(running && background_job_queues[std::min(priority, background_job_priorities-1)]->enqueue(this)) {
+		pending_background_jobs.fetch_add(1, std::memory_order_release);
+		//Notifying doesn't need the mutex, and taking it here could block the audio thread.
+		background_job_wakeup.notify_one();
+	}
+	//Nobody will run it, so finish will.
+	else references.fetch_sub(1, std::memory_order_release);
+}
+
+void BackgroundJob::finish() {
+	int expected = job_queued;
+	if(state.compare_exchange_strong(expected, job_running, std::memory_order_acquire)) {
+		run();
+		state.store(job_finished, std::memory_order_release);
+		return;
+	}
+	while(state.load(std::memory_order_acquire) != job_finished) std::this_thread::yield();
+}
+
+void BackgroundJob::drain() {
+	finish();
+	//Anything still in a queue is stale, but whoever takes it still looks at us.
+	//Help empty the queues, in case there are no workers.
+	BackgroundJob* job;
+	while(references.load(std::memory_order_acquire) != 0) {
+		if(dequeueBackgroundJob(job)) job->runFromWorker();
+		else std::this_thread::yield();
+	}
+}
+
+void BackgroundJob::runFromWorker() {
+	int expected = job_queued;
+	//If this fails, finish got here first and the queue entry is stale.
+	if(state.compare_exchange_strong(expected, job_running, std::memory_order_acquire)) {
+		run();
+		state.store(job_finished, std::memory_order_release);
+	}
+	references.fetch_sub(1, std::memory_order_release);
+}
+
+void backgroundJobThread() {
+	//Reverb tails are full of denormals.
+	becomeAudioThread(AudioThreadConfiguration(), 0, true);
+	BackgroundJob* job;
+	while(background_jobs_running.load(std::memory_order_acquire)) {
+		if(dequeueBackgroundJob(job)) {
+			job->runFromWorker();
+			continue;
+		}
+		std::unique_lock<std::mutex> l(background_job_mutex);
+		background_job_wakeup.wait_for(l, std::chrono::milliseconds(background_job_poll_interval), [] () {
+			return pending_background_jobs.load(std::memory_order_acquire) > 0 || background_jobs_running.load() == false;
+		});
+	}
+}
+
+void initializeBackgroundJobs() {
+	//The queues live until the process exits, so that jobs destroyed after shutdown can still drain.
+	if(background_job_queues.empty()) {
+		for(int i = 0; i < background_job_priorities; i++) background_job_queues.push_back(new powercores::MpmcQueue<BackgroundJob*>(1024));
+	}
+	//Leave most of the machine to the servers' own threads.
+	int count = std::max<int>(1, std::min<int>(4, std::thread::hardware_concurrency()/2));
+	background_jobs_running.store(true);
+	for(int i = 0; i < count; i++) background_job_threads.push_back(powercores::safeStartThread(backgroundJobThread));
+	logDebug("Started %i background job threads.", count);
+}
+
+void shutdownBackgroundJobs() {
+	background_jobs_running.store(false);
+	background_job_wakeup.notify_all();
+	for(auto &t: background_job_threads) t.join();
+	background_job_threads.clear();
+	//Whatever is left is stale, or will be run by finish.
+	BackgroundJob* job;
+	while(dequeueBackgroundJob(job)) job->runFromWorker();
+}
+
+}
@@ -31,10 +31,10 @@ OutputConnection::OutputConnection(std::shared_ptr<Server> server, Node* node, i
 	this->block_size = server->getBlockSize();
 }
 
-void OutputConnection::add(int inputBufferCount, float** inputBuffers, bool shouldApplyMixingMatrix) {
+bool OutputConnection::add(int inputBufferCount, float** inputBuffers, bool shouldApplyMixingMatrix) {
 	//Ticking is now handled by the planner, see planner.cpp.
-	//If the node is paused, we are going to output zeros, so skip.
-	if(node->getState() == Lav_NODESTATE_PAUSED) return;
+	//If the node is paused or silent, we are going to output zeros, so skip.
+	if(isSilent()) return false;
 	//get the array of outputs from our node.
 	float** outputArray=node->getOutputBufferArray();
 	//it is the responsibility of our node to keep us configured, so we assume what info we have is accurate. If it is not, that is the fault of our node.
@@ -47,6 +47,11 @@ void OutputConnection::add(int inputBufferCount, float** inputBuffers, bool shou
 		int channelsToAdd =std::min(count, inputBufferCount);
 		for(int i=0; i < channelsToAdd; i++) additionKernel(block_size, outputArray[i+start], inputBuffers[i], inputBuffers[i]);
 	}
+	return true;
+}
+
+bool OutputConnection::isSilent() {
+	return node->getState() == Lav_NODESTATE_PAUSED || node->isSilent();
 }
 
 void OutputConnection::reconfigure(int newStart, int newCount) {
@@ -54,10 +59,13 @@ void OutputConnection::reconfigure(int newStart, int newCount) {
 	count= newCount;
 }
 
-void OutputConnection::clear() {
+void OutputConnection::clear(TopologyCommit &commit) {
 	for(auto &c: connected_to) {
 		auto c_s= c.lock();
-		if(c_s) c_s->forgetConnection(this);
+		if(c_s) {
+			c_s->forgetConnection(this);
+			commit.inputChanged(c_s);
+		}
 	}
 	//and then kill the whole set.
 	connected_to.clear();
@@ -92,16 +100,30 @@ InputConnection::InputConnection(std::shared_ptr<Server> server, Node* node, int
 	this->start=start;
 	this->count = count;
 	this->block_size = server->getBlockSize();
+	snapshot = new InputConnectionSnapshot();
 }
 
-void InputConnection::add(bool shouldApplyMixingMatrix) {
-	addNodeless(node->getInputBufferArray(), shouldApplyMixingMatrix);
+InputConnection::~InputConnection() {
+	delete snapshot;
 }
 
-void InputConnection::addNodeless(float** inputs, bool shouldApplyMixingMatrix) {
-	for(auto &i: connected_to) {
-		i.first->add(count, inputs+start, shouldApplyMixingMatrix);
+bool InputConnection::add(bool shouldApplyMixingMatrix) {
+	return addNodeless(node->getInputBufferArray(), shouldApplyMixingMatrix);
+}
+
+bool InputConnection::addNodeless(float** inputs, bool shouldApplyMixingMatrix) {
+	bool added = false;
+	for(auto &i: snapshot->outputs) {
+		if(i->add(count, inputs+start, shouldApplyMixingMatrix)) added = true;
 	}
+	return added;
+}
+
+bool InputConnection::isSilent() {
+	for(auto &i: snapshot->outputs) {
+		if(i->isSilent() == false) return false;
+	}
+	return true;
 }
 
 void InputConnection::reconfigure(int newStart, int newCount) {
@@ -132,25 +154,55 @@ Node* InputConnection::getNode() {
 
 std::vector<Node*> InputConnection::getConnectedNodes() {
 	std::vector<Node*> retval;
-	for(auto &i: connected_to) {
-		auto n= i.first->getNode();
+	for(auto &i: snapshot->outputs) {
+		auto n= i->getNode();
 		retval.push_back(n);
 	}
 	return retval;
 }
 
 int InputConnection::getConnectedNodeCount() {
-	return (int)getConnectedNodes().size();
+	return (int)snapshot->outputs.size();
+}
+
+InputConnectionSnapshot* InputConnection::makeSnapshot() {
+	auto ret = new InputConnectionSnapshot();
+	ret->outputs.reserve(connected_to.size());
+	ret->nodes.reserve(connected_to.size());
+	for(auto &i: connected_to) {
+		ret->outputs.push_back(i.first);
+		ret->nodes.push_back(i.second);
+	}
+	return ret;
+}
+
+InputConnectionSnapshot* InputConnection::swapSnapshot(InputConnectionSnapshot* newSnapshot) {
+	auto old = snapshot;
+	snapshot = newSnapshot;
+	return old;
+}
+
+TopologyCommit::~TopologyCommit() {
+	for(auto &i: snapshots) delete i.second;
+}
+
+void TopologyCommit::inputChanged(std::shared_ptr<InputConnection> input) {
+	for(auto &i: snapshots) {
+		if(i.first == input) return;
+	}
+	snapshots.emplace_back(input, nullptr);
 }
 
-void makeConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input) {
+void makeConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input, TopologyCommit &commit) {
 	output->connectHalf(input);
 	input->connectHalf(output);
+	commit.inputChanged(input);
 }
 
-void breakConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input) {
+void breakConnection(std::shared_ptr<OutputConnection> output, std::shared_ptr<InputConnection> input, TopologyCommit &commit) {
 	output->disconnectHalf(input);
 	input->disconnectHalf(output);
+	commit.inputChanged(input);
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**The plan cache, and the kissfft backend which handles anything the SIMD one can't.*/
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/constants.hpp>
+#include <libaudioverse/private/logging.hpp>
+#include <kiss_fft.h>
+#include <kiss_fftr.h>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <math.h>
+
+namespace libaudioverse_implementation {
+
+int FftPlan::getSize() {
+	return size;
+}
+
+int FftPlan::getBinCount() {
+	return bin_count;
+}
+
+int FftPlan::getScratchSize() {
+	return scratch_size;
+}
+
+const char* FftPlan::getBackendName() {
+	return backend_name;
+}
+
+Fft::Fft(int size) {
+	plan = getFftPlan(size);
+	scratch = allocArray<float>(plan->getScratchSize());
+}
+
+Fft::~Fft() {
+	freeArray(scratch);
+}
+
+void Fft::forward(float* input, float* outReal, float* outImag) {
+	plan->forward(input, outReal, outImag, scratch);
+}
+
+void Fft::inverse(float* inReal, float* inImag, float* output) {
+	plan->inverse(inReal, inImag, output, scratch);
+}
+
+int Fft::getSize() {
+	return plan->getSize();
+}
+
+int Fft::getBinCount() {
+	return plan->getBinCount();
+}
+
+const char* Fft::getBackendName() {
+	return plan->getBackendName();
+}
+
+/**We don't use kiss_fftr: it keeps its scratch space in the config, so a config can't be shared between threads.
+Instead, this is the same trick on top of a complex kiss_fft of half the size, whose configs are read-only for the sizes we use.
+The even samples are the real parts and the odd samples the imaginary parts, so the input is already the complex signal.*/
+class KissFftPlan: public FftPlan {
+	public:
+	KissFftPlan(int size);
+	~KissFftPlan();
+	void forward(float* input, float* outReal, float* outImag, float* scratch) override;
+	void inverse(float* inReal, float* inImag, float* output, float* scratch) override;
+	private:
+	int half_size = 0;
+	kiss_fft_cfg fft = nullptr, ifft = nullptr;
+	//e^(-2 pi i k/size).
+	float* twiddles_real = nullptr, *twiddles_imag = nullptr;
+};
+
+KissFftPlan::KissFftPlan(int size) {
+	this->size = size;
+	half_size = size/2;
+	bin_count = half_size+1;
+	scratch_size = size;
+	backend_name = "kissfft";
+	fft = kiss_fft_alloc(half_size, 0, nullptr, nullptr);
+	ifft = kiss_fft_alloc(half_size, 1, nullptr, nullptr);
+	twiddles_real = allocArray<float>(half_size);
+	twiddles_imag = allocArray<float>(half_size);
+	for(int k = 0; k < half_size; k++) {
+		twiddles_real[k] = (float)cos(2*PI*k/size);
+		twiddles_imag[k] = (float)-sin(2*PI*k/size);
+	}
+}
+
+KissFftPlan::~KissFftPlan() {
+	kiss_fft_free(fft);
+	kiss_fft_free(ifft);
+	freeArray(twiddles_real);
+	freeArray(twiddles_imag);
+}
+
+void KissFftPlan::forward(float* input, float* outReal, float* outImag, float* scratch) {
+	kiss_fft_cpx* z = (kiss_fft_cpx*)scratch;
+	kiss_fft(fft, (kiss_fft_cpx*)input, z);
+	outReal[0] = z[0].r+z[0].i;
+	outImag[0] = 0.0f;
+	outReal[half_size] = z[0].r-z[0].i;
+	outImag[half_size] = 0.0f;
+	//Split z into the spectra of the even and odd samples, then put them back together.
+	for(int k = 1; k < half_size; k++) {
+		kiss_fft_cpx a = z[k], b = z[half_size-k];
+		float evenReal = (a.r+b.r)*0.5f, evenImag = (a.i-b.i)*0.5f;
+		float oddReal = (a.i+b.i)*0.5f, oddImag = (b.r-a.r)*0.5f;
+		outReal[k] = evenReal+oddReal*twiddles_real[k]-oddImag*twiddles_imag[k];
+		outImag[k] = evenImag+oddReal*twiddles_imag[k]+oddImag*twiddles_real[k];
+	}
+}
+
+void KissFftPlan::inverse(float* inReal, float* inImag, float* output, float* scratch) {
+	kiss_fft_cpx* z = (kiss_fft_cpx*)scratch;
+	//The reverse of forward, without the halving, so that the result comes out scaled by size.
+	for(int k = 0; k < half_size; k++) {
+		int j = half_size-k;
+		float evenReal = inReal[k]+inReal[j], evenImag = inImag[k]-inImag[j];
+		float diffReal = inReal[k]-inReal[j], diffImag = inImag[k]+inImag[j];
+		//Times the conjugate of the twiddle.
+		float oddReal = diffReal*twiddles_real[k]+diffImag*twiddles_imag[k];
+		float oddImag = diffImag*twiddles_real[k]-diffReal*twiddles_imag[k];
+		z[k].r = evenReal-oddImag;
+		z[k].i = evenImag+oddReal;
+	}
+	kiss_fft(ifft, z, (kiss_fft_cpx*)output);
+}
+
+FftPlan* createKissFftPlan(int size) {
+	return new KissFftPlan(size);
+}
+
+std::map<int, std::shared_ptr<FftPlan>> *fft_plan_cache;
+std::mutex *fft_plan_cache_mutex;
+
+void initializeFft() {
+	fft_plan_cache = new std::map<int, std::shared_ptr<FftPlan>>();
+	fft_plan_cache_mutex = new std::mutex();
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	logInfo("Using SIMD ffts for powers of 2 from %i.", simd_fft_minimum_size);
+	#endif
+}
+
+void shutdownFft() {
+	delete fft_plan_cache_mutex;
+	delete fft_plan_cache;
+}
+
+bool isPowerOfTwo(int size) {
+	return size > 0 && (size&(size-1)) == 0;
+}
+
+int getFftSize(int atLeast) {
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	int size = simd_fft_minimum_size;
+	while(size < atLeast) size *= 2;
+	return size;
+	#else
+	return kiss_fftr_next_fast_size_real(atLeast);
+	#endif
+}
+
+std::shared_ptr<FftPlan> getFftPlan(int size) {
+	std::lock_guard<std::mutex> guard(*fft_plan_cache_mutex);
+	auto found = fft_plan_cache->find(size);
+	if(found != fft_plan_cache->end()) return found->second;
+	std::shared_ptr<FftPlan> plan;
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	if(isPowerOfTwo(size) && size >= simd_fft_minimum_size) plan = std::shared_ptr<FftPlan>(createSimdFftPlan(size));
+	#endif
+	//Real ffts always split the input in half, so odd sizes are a bug.
+	if(plan == nullptr) plan = std::shared_ptr<FftPlan>(createKissFftPlan(size));
+	(*fft_plan_cache)[size] = plan;
+	return plan;
+}
+
+}
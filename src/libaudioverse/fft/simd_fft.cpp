@@ -0,0 +1,272 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**SSE2 real ffts for powers of 2.
+
+A real fft of size n is a complex fft of size n/2 on the even samples as the real parts and the odd samples as the imaginary parts, plus a pass to pull the two spectra apart.
+The complex fft is Stockham autosort: radix 4 as long as possible, and one radix 2 pass at the end if the size needs it.
+Stockham never shuffles in place, so it ping-pongs between two buffers, but every pass reads and writes contiguous runs.
+Everything is kept as separate real and imaginary arrays, so a vector is always 4 of the same thing and there's no shuffling to do complex math.
+
+The first pass has a stride of 1, so it goes across butterflies instead and transposes on the way out.
+Every other pass has a stride of at least 4, so it goes across the stride with the twiddles broadcast.*/
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/constants.hpp>
+#include <utility>
+#include <math.h>
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+namespace libaudioverse_implementation {
+
+class SimdFftPlan: public FftPlan {
+	public:
+	SimdFftPlan(int size);
+	~SimdFftPlan();
+	void forward(float* input, float* outReal, float* outImag, float* scratch) override;
+	void inverse(float* inReal, float* inImag, float* output, float* scratch) override;
+	private:
+	//Forward complex fft of x, using y as the other buffer.
+	//The result is in x after an even number of passes, and in y after an odd number.
+	void complexForward(float* xr, float* xi, float* yr, float* yi);
+	void firstPass(int n, float* twiddles, float* xr, float* xi, float* yr, float* yi);
+	void radix4Pass(int n, int s, float* twiddles, float* xr, float* xi, float* yr, float* yi);
+	void radix2Pass(int s, float* xr, float* xi, float* yr, float* yi);
+	int half_size = 0, radix4_passes = 0;
+	bool has_radix2_pass = false;
+	//For each radix 4 pass of length n: w^p, w^2p, and w^3p for p < n/4, real parts then imaginary parts, where w is e^(-2 pi i/n).
+	float* pass_twiddles = nullptr;
+	//e^(-2 pi i k/size), for splitting the spectra apart.
+	float* real_twiddles_real = nullptr, *real_twiddles_imag = nullptr;
+};
+
+SimdFftPlan::SimdFftPlan(int size) {
+	this->size = size;
+	half_size = size/2;
+	bin_count = half_size+1;
+	//Two complex buffers of half_size.
+	scratch_size = 4*half_size;
+	backend_name = "SSE2";
+	int n = half_size;
+	int twiddleCount = 0;
+	while(n >= 4) {
+		radix4_passes++;
+		twiddleCount += 6*(n/4);
+		n /= 4;
+	}
+	has_radix2_pass = n == 2;
+	pass_twiddles = allocArray<float>(twiddleCount);
+	float* t = pass_twiddles;
+	n = half_size;
+	for(int pass = 0; pass < radix4_passes; pass++) {
+		int m = n/4;
+		for(int p = 0; p < m; p++) {
+			for(int j = 1; j <= 3; j++) {
+				t[(j-1)*2*m+p] = (float)cos(2*PI*j*p/n);
+				t[(j-1)*2*m+m+p] = (float)-sin(2*PI*j*p/n);
+			}
+		}
+		t += 6*m;
+		n /= 4;
+	}
+	//The splitting pass goes up to half_size/2, 4 at a time starting from 1.
+	real_twiddles_real = allocArray<float>(half_size/2+1);
+	real_twiddles_imag = allocArray<float>(half_size/2+1);
+	for(int k = 0; k <= half_size/2; k++) {
+		real_twiddles_real[k] = (float)cos(2*PI*k/size);
+		real_twiddles_imag[k] = (float)-sin(2*PI*k/size);
+	}
+}
+
+SimdFftPlan::~SimdFftPlan() {
+	freeArray(pass_twiddles);
+	freeArray(real_twiddles_real);
+	freeArray(real_twiddles_imag);
+}
+
+inline __m128 reverse(__m128 x) {
+	return _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+//The radix 4 butterfly, with the twiddles applied to the outputs.
+//w1, w2, and w3 are real then imaginary.
+inline void butterfly4(__m128 ar, __m128 ai, __m128 br, __m128 bi, __m128 cr, __m128 ci, __m128 dr, __m128 di,
+__m128 w1r, __m128 w1i, __m128 w2r, __m128 w2i, __m128 w3r, __m128 w3i,
+__m128 &y0r, __m128 &y0i, __m128 &y1r, __m128 &y1i, __m128 &y2r, __m128 &y2i, __m128 &y3r, __m128 &y3i) {
+	__m128 t0r = _mm_add_ps(ar, cr), t0i = _mm_add_ps(ai, ci);
+	__m128 t1r = _mm_sub_ps(ar, cr), t1i = _mm_sub_ps(ai, ci);
+	__m128 t2r = _mm_add_ps(br, dr), t2i = _mm_add_ps(bi, di);
+	//-i(b-d).
+	__m128 t3r = _mm_sub_ps(bi, di), t3i = _mm_sub_ps(dr, br);
+	y0r = _mm_add_ps(t0r, t2r);
+	y0i = _mm_add_ps(t0i, t2i);
+	__m128 ur = _mm_add_ps(t1r, t3r), ui = _mm_add_ps(t1i, t3i);
+	y1r = _mm_sub_ps(_mm_mul_ps(ur, w1r), _mm_mul_ps(ui, w1i));
+	y1i = _mm_add_ps(_mm_mul_ps(ur, w1i), _mm_mul_ps(ui, w1r));
+	ur = _mm_sub_ps(t0r, t2r);
+	ui = _mm_sub_ps(t0i, t2i);
+	y2r = _mm_sub_ps(_mm_mul_ps(ur, w2r), _mm_mul_ps(ui, w2i));
+	y2i = _mm_add_ps(_mm_mul_ps(ur, w2i), _mm_mul_ps(ui, w2r));
+	ur = _mm_sub_ps(t1r, t3r);
+	ui = _mm_sub_ps(t1i, t3i);
+	y3r = _mm_sub_ps(_mm_mul_ps(ur, w3r), _mm_mul_ps(ui, w3i));
+	y3i = _mm_add_ps(_mm_mul_ps(ur, w3i), _mm_mul_ps(ui, w3r));
+}
+
+void SimdFftPlan::firstPass(int n, float* twiddles, float* xr, float* xi, float* yr, float* yi) {
+	int m = n/4;
+	float* w1r = twiddles, *w1i = twiddles+m, *w2r = twiddles+2*m, *w2i = twiddles+3*m, *w3r = twiddles+4*m, *w3i = twiddles+5*m;
+	for(int p = 0; p < m; p += 4) {
+		__m128 y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i;
+		butterfly4(_mm_loadu_ps(xr+p), _mm_loadu_ps(xi+p), _mm_loadu_ps(xr+p+m), _mm_loadu_ps(xi+p+m),
+		_mm_loadu_ps(xr+p+2*m), _mm_loadu_ps(xi+p+2*m), _mm_loadu_ps(xr+p+3*m), _mm_loadu_ps(xi+p+3*m),
+		_mm_loadu_ps(w1r+p), _mm_loadu_ps(w1i+p), _mm_loadu_ps(w2r+p), _mm_loadu_ps(w2i+p), _mm_loadu_ps(w3r+p), _mm_loadu_ps(w3i+p),
+		y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i);
+		//Output j of butterfly p goes to 4p+j.
+		_MM_TRANSPOSE4_PS(y0r, y1r, y2r, y3r);
+		_MM_TRANSPOSE4_PS(y0i, y1i, y2i, y3i);
+		_mm_storeu_ps(yr+4*p, y0r);
+		_mm_storeu_ps(yr+4*p+4, y1r);
+		_mm_storeu_ps(yr+4*p+8, y2r);
+		_mm_storeu_ps(yr+4*p+12, y3r);
+		_mm_storeu_ps(yi+4*p, y0i);
+		_mm_storeu_ps(yi+4*p+4, y1i);
+		_mm_storeu_ps(yi+4*p+8, y2i);
+		_mm_storeu_ps(yi+4*p+12, y3i);
+	}
+}
+
+void SimdFftPlan::radix4Pass(int n, int s, float* twiddles, float* xr, float* xi, float* yr, float* yi) {
+	int m = n/4;
+	int quarter = s*m;
+	for(int p = 0; p < m; p++) {
+		__m128 w1r = _mm_set1_ps(twiddles[p]), w1i = _mm_set1_ps(twiddles[m+p]);
+		__m128 w2r = _mm_set1_ps(twiddles[2*m+p]), w2i = _mm_set1_ps(twiddles[3*m+p]);
+		__m128 w3r = _mm_set1_ps(twiddles[4*m+p]), w3i = _mm_set1_ps(twiddles[5*m+p]);
+		float* inr = xr+s*p, *ini = xi+s*p;
+		float* outr = yr+4*s*p, *outi = yi+4*s*p;
+		for(int q = 0; q < s; q += 4) {
+			__m128 y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i;
+			butterfly4(_mm_loadu_ps(inr+q), _mm_loadu_ps(ini+q), _mm_loadu_ps(inr+quarter+q), _mm_loadu_ps(ini+quarter+q),
+			_mm_loadu_ps(inr+2*quarter+q), _mm_loadu_ps(ini+2*quarter+q), _mm_loadu_ps(inr+3*quarter+q), _mm_loadu_ps(ini+3*quarter+q),
+			w1r, w1i, w2r, w2i, w3r, w3i,
+			y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i);
+			_mm_storeu_ps(outr+q, y0r);
+			_mm_storeu_ps(outi+q, y0i);
+			_mm_storeu_ps(outr+s+q, y1r);
+			_mm_storeu_ps(outi+s+q, y1i);
+			_mm_storeu_ps(outr+2*s+q, y2r);
+			_mm_storeu_ps(outi+2*s+q, y2i);
+			_mm_storeu_ps(outr+3*s+q, y3r);
+			_mm_storeu_ps(outi+3*s+q, y3i);
+		}
+	}
+}
+
+//Always the last pass, where n is 2 and the twiddle is 1.
+void SimdFftPlan::radix2Pass(int s, float* xr, float* xi, float* yr, float* yi) {
+	for(int q = 0; q < s; q += 4) {
+		__m128 ar = _mm_loadu_ps(xr+q), ai = _mm_loadu_ps(xi+q);
+		__m128 br = _mm_loadu_ps(xr+s+q), bi = _mm_loadu_ps(xi+s+q);
+		_mm_storeu_ps(yr+q, _mm_add_ps(ar, br));
+		_mm_storeu_ps(yi+q, _mm_add_ps(ai, bi));
+		_mm_storeu_ps(yr+s+q, _mm_sub_ps(ar, br));
+		_mm_storeu_ps(yi+s+q, _mm_sub_ps(ai, bi));
+	}
+}
+
+void SimdFftPlan::complexForward(float* xr, float* xi, float* yr, float* yi) {
+	int n = half_size, s = 1;
+	float* twiddles = pass_twiddles;
+	for(int pass = 0; pass < radix4_passes; pass++) {
+		if(pass == 0) firstPass(n, twiddles, xr, xi, yr, yi);
+		else radix4Pass(n, s, twiddles, xr, xi, yr, yi);
+		twiddles += 6*(n/4);
+		n /= 4;
+		s *= 4;
+		std::swap(xr, yr);
+		std::swap(xi, yi);
+	}
+	if(has_radix2_pass) radix2Pass(s, xr, xi, yr, yi);
+}
+
+void SimdFftPlan::forward(float* input, float* outReal, float* outImag, float* scratch) {
+	int passes = radix4_passes+has_radix2_pass;
+	float* ar = scratch, *ai = scratch+half_size, *br = scratch+2*half_size, *bi = scratch+3*half_size;
+	//Start wherever makes the result land in a.
+	float* split[] = {passes%2 ? br : ar, passes%2 ? bi : ai};
+	uninterleaveSamples(2, half_size, input, 2, split);
+	if(passes%2) complexForward(br, bi, ar, ai);
+	else complexForward(ar, ai, br, bi);
+	outReal[0] = ar[0]+ai[0];
+	outImag[0] = 0.0f;
+	outReal[half_size] = ar[0]-ai[0];
+	outImag[half_size] = 0.0f;
+	//Bins k and half_size-k come from the same two complex bins, so do both at once.
+	//With even the spectrum of the even samples and odd that of the odd samples, bin k is even+w*odd and bin half_size-k is the conjugate of even-w*odd.
+	__m128 half = _mm_set1_ps(0.5f);
+	for(int k = 1; k <= half_size/2; k += 4) {
+		int j = half_size-k-3;
+		__m128 zr = _mm_loadu_ps(ar+k), zi = _mm_loadu_ps(ai+k);
+		__m128 mr = reverse(_mm_loadu_ps(ar+j)), mi = reverse(_mm_loadu_ps(ai+j));
+		__m128 wr = _mm_loadu_ps(real_twiddles_real+k), wi = _mm_loadu_ps(real_twiddles_imag+k);
+		__m128 er = _mm_mul_ps(_mm_add_ps(zr, mr), half), ei = _mm_mul_ps(_mm_sub_ps(zi, mi), half);
+		__m128 or_ = _mm_mul_ps(_mm_add_ps(zi, mi), half), oi = _mm_mul_ps(_mm_sub_ps(mr, zr), half);
+		__m128 tr = _mm_sub_ps(_mm_mul_ps(or_, wr), _mm_mul_ps(oi, wi));
+		__m128 ti = _mm_add_ps(_mm_mul_ps(or_, wi), _mm_mul_ps(oi, wr));
+		_mm_storeu_ps(outReal+k, _mm_add_ps(er, tr));
+		_mm_storeu_ps(outImag+k, _mm_add_ps(ei, ti));
+		_mm_storeu_ps(outReal+j, reverse(_mm_sub_ps(er, tr)));
+		_mm_storeu_ps(outImag+j, reverse(_mm_sub_ps(ti, ei)));
+	}
+}
+
+void SimdFftPlan::inverse(float* inReal, float* inImag, float* output, float* scratch) {
+	int passes = radix4_passes+has_radix2_pass;
+	float* ar = scratch, *ai = scratch+half_size, *br = scratch+2*half_size, *bi = scratch+3*half_size;
+	float* startr = passes%2 ? br : ar, *starti = passes%2 ? bi : ai;
+	//The inverse of a complex fft is the forward one with real and imaginary swapped on the way in and out.
+	//So we write the real parts to the imaginary array and vice versa.
+	float* zr = starti, *zi = startr;
+	zr[0] = inReal[0]+inReal[half_size];
+	zi[0] = inReal[0]-inReal[half_size];
+	//The reverse of the splitting in forward, without the halving, so that the result comes out scaled by size.
+	//Bin k is even+i*odd and bin half_size-k is the conjugate of even-i*odd.
+	for(int k = 1; k <= half_size/2; k += 4) {
+		int j = half_size-k-3;
+		__m128 xr = _mm_loadu_ps(inReal+k), xi = _mm_loadu_ps(inImag+k);
+		__m128 mr = reverse(_mm_loadu_ps(inReal+j)), mi = reverse(_mm_loadu_ps(inImag+j));
+		__m128 wr = _mm_loadu_ps(real_twiddles_real+k), wi = _mm_loadu_ps(real_twiddles_imag+k);
+		__m128 er = _mm_add_ps(xr, mr), ei = _mm_sub_ps(xi, mi);
+		__m128 dr = _mm_sub_ps(xr, mr), di = _mm_add_ps(xi, mi);
+		//Times the conjugate of the twiddle.
+		__m128 or_ = _mm_add_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi));
+		__m128 oi = _mm_sub_ps(_mm_mul_ps(di, wr), _mm_mul_ps(dr, wi));
+		_mm_storeu_ps(zr+k, _mm_sub_ps(er, oi));
+		_mm_storeu_ps(zi+k, _mm_add_ps(ei, or_));
+		_mm_storeu_ps(zr+j, reverse(_mm_add_ps(er, oi)));
+		_mm_storeu_ps(zi+j, reverse(_mm_sub_ps(or_, ei)));
+	}
+	if(passes%2) complexForward(br, bi, ar, ai);
+	else complexForward(ar, ai, br, bi);
+	//And swap back.
+	float* split[] = {ai, ar};
+	interleaveSamples(2, half_size, 2, split, output);
+}
+
+FftPlan* createSimdFftPlan(int size) {
+	return new SimdFftPlan(size);
+}
+
+}
+
+#endif
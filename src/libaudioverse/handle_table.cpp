@@ -0,0 +1,116 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#include <libaudioverse/private/handle_table.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/error.hpp>
+#include <libaudioverse/libaudioverse.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libaudioverse_implementation {
+
+HandleTable::HandleTable() {
+	for(auto &c: chunks) c.store(nullptr);
+}
+
+HandleTable::~HandleTable() {
+	for(auto &c: chunks) delete[] c.load();
+}
+
+int HandleTable::allocate() {
+	std::lock_guard<std::mutex> guard(mutex);
+	uint32_t index;
+	if(free_indices.size() > reuse_threshold) {
+		index = free_indices.front();
+		free_indices.pop_front();
+	}
+	else {
+		if(next_index > index_mask) ERROR(Lav_ERROR_MEMORY, "Too many objects.");
+		index = next_index++;
+		if(chunks[index >> chunk_bits].load() == nullptr) chunks[index >> chunk_bits].store(new Slot[chunk_size], std::memory_order_release);
+	}
+	uint64_t generation = getSlot(index)->state.load() >> 32;
+	return (int)((generation << index_bits) | index);
+}
+
+void HandleTable::release(int handle) {
+	std::shared_ptr<ExternalObject> strong;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		uint32_t index = (uint32_t)handle & index_mask;
+		auto &slot = *getSlot(index);
+		uint64_t generation = slot.state.load() >> 32;
+		beginWrite(slot);
+		slot.object.reset();
+		slot.type = 0;
+		//Normally already gone, since whatever is dying was only kept alive by this.
+		strong = std::move(slot.strong);
+		endWrite(slot, generation == max_generation ? 1 : generation+1);
+		free_indices.push_back(index);
+	}
+}
+
+void HandleTable::publish(std::shared_ptr<ExternalObject> obj) {
+	std::lock_guard<std::mutex> guard(mutex);
+	auto &slot = *getSlot((uint32_t)obj->external_object_handle & index_mask);
+	//The weak pointer is set once; after that, only the strong reference comes and goes.
+	if(slot.object.expired()) {
+		uint64_t generation = slot.state.load() >> 32;
+		beginWrite(slot);
+		slot.object = obj;
+		slot.type = obj->getType();
+		endWrite(slot, generation);
+	}
+	slot.strong = obj;
+}
+
+void HandleTable::dropStrongReference(int handle) {
+	std::shared_ptr<ExternalObject> strong;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		auto slot = getSlot((uint32_t)handle & index_mask);
+		if(slot) strong = std::move(slot->strong);
+	}
+	//strong may have been the last reference, and destroying it calls release, so it has to die out here.
+}
+
+void HandleTable::dropAllStrongReferences() {
+	std::vector<std::shared_ptr<ExternalObject>> strong;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		for(uint32_t i = 0; i < next_index; i++) {
+			auto slot = getSlot(i);
+			if(slot->strong) strong.push_back(std::move(slot->strong));
+		}
+	}
+}
+
+std::vector<std::shared_ptr<ExternalObject>> HandleTable::getLiveObjects() {
+	std::vector<std::shared_ptr<ExternalObject>> retval;
+	std::lock_guard<std::mutex> guard(mutex);
+	for(uint32_t i = 0; i < next_index; i++) {
+		auto obj = getSlot(i)->object.lock();
+		if(obj) retval.push_back(obj);
+	}
+	return retval;
+}
+
+void HandleTable::beginWrite(Slot& slot) {
+	//The mutex keeps other writers out, so this only races readers.
+	slot.state.fetch_or(writer_bit, std::memory_order_acq_rel);
+	while(slot.state.load(std::memory_order_acquire) & pin_mask) std::this_thread::yield();
+}
+
+void HandleTable::endWrite(Slot& slot, uint64_t generation) {
+	slot.state.store(generation << 32, std::memory_order_release);
+}
+
+}
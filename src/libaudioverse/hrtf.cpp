@@ -26,7 +26,6 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <math.h>
-#include <kiss_fftr.h>
 #include <memory>
 #include <algorithm>
 #include <map>
@@ -49,7 +49,8 @@ void BlockConvolver::convolve(float* input, float* output) {
 	int historyLength =response_length+block_size;
 	std::copy(history+historyLength-response_length, history+historyLength, history);
 	std::copy(input, input+block_size, history+historyLength-block_size);
-	convolutionKernel(history, block_size, output, response_length, response);
+	//The kernel wants response_length-1 samples of history, one less than we keep.
+	convolutionKernel(history+1, block_size, output, response_length, response);
 }
 
 void BlockConvolver::reset() {
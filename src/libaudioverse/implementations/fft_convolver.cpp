@@ -8,11 +8,12 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/dspmath.hpp>
 #include <libaudioverse/private/kernels.hpp>
 #include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/response_spectra.hpp>
 #include <libaudioverse/implementations/convolvers.hpp>
 #include <algorithm>
 #include <functional>
 #include <math.h>
-#include <kiss_fftr.h>
 
 namespace libaudioverse_implementation {
 
@@ -24,12 +25,14 @@ FftConvolver::FftConvolver(int blockSize): block_size(blockSize) {
 FftConvolver::~FftConvolver() {
 	if(workspace) freeArray(workspace);
 	if(tail) freeArray(tail);
-	if(fft) kiss_fftr_free(fft);
-	if(ifft) kiss_fftr_free(ifft);
+	if(fft) delete fft;
+	if(block_real) freeArray(block_real);
+	if(block_imag) freeArray(block_imag);
 }
 
 void FftConvolver::setResponse(int length, float* newResponse) {
-	int neededLength= kiss_fftr_next_fast_size_real	(block_size+length);
+	//Qualified, because of our own getFftSize.
+	int neededLength= libaudioverse_implementation::getFftSize(block_size+length);
 	int newTailSize=neededLength-block_size;
 	if(neededLength !=fft_size || tail_size !=newTailSize) {
 		if(workspace) freeArray(workspace);
@@ -39,48 +42,46 @@ void FftConvolver::setResponse(int length, float* newResponse) {
 		fft_size=neededLength/2+1;
 		workspace_size=neededLength;
 		tail_size=newTailSize;
-		if(fft) kiss_fftr_free(fft);
-		fft = kiss_fftr_alloc(workspace_size, 0, nullptr, nullptr);
-		if(ifft) kiss_fftr_free(ifft);
-		ifft=kiss_fftr_alloc(workspace_size, 1, nullptr, nullptr);
-		if(response_fft) freeArray(response_fft);
-		response_fft=allocArray<kiss_fft_cpx>(fft_size);
-		if(block_fft) freeArray(block_fft);
-		block_fft=allocArray<kiss_fft_cpx>(fft_size);
+		if(fft) delete fft;
+		fft = new Fft(workspace_size);
+		if(block_real) freeArray(block_real);
+		block_real=allocArray<float>(fft_size);
+		if(block_imag) freeArray(block_imag);
+		block_imag=allocArray<float>(fft_size);
 	}
-	memset(workspace, 0, sizeof(float)*workspace_size);
-	//Store the fft of the response.
-	std::copy(newResponse, newResponse+length, workspace);
-	kiss_fftr(fft, workspace, response_fft);
+	//The whole response is one partition.
+	response_spectrum = getResponseSpectrum(workspace_size, length, length, newResponse);
 }
 
 void FftConvolver::convolve(float* input, float* output) {
-	convolveFft(getFft(input), output);
+	getFft(input, block_real, block_imag);
+	convolveFft(block_real, block_imag, output);
 }
 
 int FftConvolver::getFftSize() {
 	return workspace_size;
 }
 
-kiss_fft_cpx *FftConvolver::getFft(float* input) {
+void FftConvolver::getFft(float* input, float* real, float* imag) {
 	//We reuse workspace, so have to zero the tail part of it.
 	std::fill(workspace+block_size, workspace+workspace_size, 0.0);
 	//Copy input to the workspace, and take its fft.
 	std::copy(input, input+block_size, workspace);
-	kiss_fftr(fft, workspace, block_fft);
-	return block_fft;
+	fft->forward(workspace, real, imag);
 }
 
-void FftConvolver::convolveFft(kiss_fft_cpx *fft, float* output) {
+void FftConvolver::convolveFft(float* real, float* imag, float* output) {
 	//Do a complex multiply.
 	//Note that the first line is subtraction because of the i^2.
+	//The input may be the block arrays, so read each bin before writing it.
+	float* response_real = response_spectrum->getReal(0), *response_imag = response_spectrum->getImag(0);
 	for(int i=0; i < fft_size; i++) {
-		kiss_fft_cpx tmp;
-		tmp.r = fft[i].r*response_fft[i].r-fft[i].i*response_fft[i].i;
-		tmp.i = fft[i].r*response_fft[i].i+fft[i].i*response_fft[i].r;
-		block_fft[i] = tmp;
+		float r = real[i]*response_real[i]-imag[i]*response_imag[i];
+		float im = real[i]*response_imag[i]+imag[i]*response_real[i];
+		block_real[i] = r;
+		block_imag[i] = im;
 	}
-	kiss_fftri(ifft, block_fft, workspace);
+	fft->inverse(block_real, block_imag, workspace);
 	//Add the tail over the block.
 	additionKernel(tail_size, tail, workspace, workspace);
 	//Downscale the first part, our output.
@@ -0,0 +1,150 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/background_jobs.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace libaudioverse_implementation {
+
+//Past this, bigger ffts stop paying for themselves. Never less than a block.
+const int max_level_partition_size = 16384;
+//A time-domain head costs block_size^2 multiplies, which passes the cost of a pair of ffts around here.
+const int max_time_domain_head = 256;
+
+/**One level: a PartitionedConvolver run on the background job workers, a partition at a time.
+
+Level k (from 0) has partitions of block_size*2^k and starts (2^(k+1)-1) blocks into the response.
+That is exactly late enough that a partition of input handed off as soon as it's complete is due back a partition later, when the next one is handed off.*/
+class ConvolutionLevel: public BackgroundJob {
+	public:
+	ConvolutionLevel(int partitionSize, int offset, int length, float* response, int priority);
+	~ConvolutionLevel();
+	void run() override;
+	void reset();
+	int partition_size, offset, priority;
+	PartitionedConvolver convolver;
+	//The caller fills filling; the job reads working. They swap when the job is handed off.
+	float* filling, *working, *result;
+	int filled = 0;
+	bool has_result = false;
+};
+
+ConvolutionLevel::ConvolutionLevel(int partitionSize, int offset, int length, float* response, int priority): partition_size(partitionSize), offset(offset), priority(priority), convolver(partitionSize, length, response) {
+	filling = allocArray<float>(partition_size);
+	working = allocArray<float>(partition_size);
+	result = allocArray<float>(partition_size);
+}
+
+ConvolutionLevel::~ConvolutionLevel() {
+	drain();
+	freeArray(filling);
+	freeArray(working);
+	freeArray(result);
+}
+
+void ConvolutionLevel::run() {
+	convolver.convolve(working, result);
+}
+
+void ConvolutionLevel::reset() {
+	finish();
+	convolver.reset();
+	filled = 0;
+	has_result = false;
+}
+
+NonuniformConvolver::NonuniformConvolver(int blockSize): block_size(blockSize) {
+	if(block_size <= max_time_domain_head) time_domain_head = new BlockConvolver(block_size);
+	else fft_head = new PartitionedConvolver(block_size);
+}
+
+NonuniformConvolver::~NonuniformConvolver() {
+	clearLevels();
+	delete time_domain_head;
+	delete fft_head;
+}
+
+void NonuniformConvolver::clearLevels() {
+	for(auto l: levels) delete l;
+	levels.clear();
+	if(output_ring) freeArray(output_ring);
+	output_ring = nullptr;
+	output_ring_size = 0;
+}
+
+void NonuniformConvolver::setResponse(int length, float* response) {
+	clearLevels();
+	response_length = length;
+	if(time_domain_head) time_domain_head->setResponse(std::min(length, block_size), response);
+	else fft_head->setResponse(std::min(length, block_size), response);
+	//Partitions have to keep doubling for the schedule above to work, so the biggest is block_size*2^k.
+	int maxPartition = block_size;
+	while(2*maxPartition <= max_level_partition_size) maxPartition *= 2;
+	int offset = block_size, partition = block_size;
+	while(offset < length) {
+		int remaining = length-offset;
+		//Two partitions, unless this is as big as they get.
+		int covers = partition == maxPartition ? remaining : std::min(remaining, 2*partition);
+		levels.push_back(new ConvolutionLevel(partition, offset, covers, response+offset, levels.size()));
+		offset += covers;
+		partition = std::min(2*partition, maxPartition);
+	}
+	if(levels.size()) {
+		//Results go in at most a partition ahead of the block being output.
+		output_ring_size = levels.back()->partition_size+block_size;
+		output_ring = allocArray<float>(output_ring_size);
+	}
+	reset();
+}
+
+void NonuniformConvolver::convolve(float* input, float* output) {
+	if(time_domain_head) time_domain_head->convolve(input, output);
+	else fft_head->convolve(input, output);
+	if(levels.empty()) return;
+	for(auto l: levels) {
+		std::copy(input, input+block_size, l->filling+l->filled);
+		l->filled += block_size;
+		if(l->filled < l->partition_size) continue;
+		//The last hand-off is due now, and its result starts with this block.
+		l->finish();
+		if(l->has_result) {
+			int first = std::min(l->partition_size, output_ring_size-ring_position);
+			additionKernel(first, l->result, output_ring+ring_position, output_ring+ring_position);
+			additionKernel(l->partition_size-first, l->result+first, output_ring, output_ring);
+		}
+		std::swap(l->filling, l->working);
+		l->filled = 0;
+		l->has_result = true;
+		l->submit(l->priority);
+	}
+	additionKernel(block_size, output_ring+ring_position, output, output);
+	std::fill(output_ring+ring_position, output_ring+ring_position+block_size, 0.0f);
+	ring_position += block_size;
+	if(ring_position == output_ring_size) ring_position = 0;
+}
+
+void NonuniformConvolver::reset() {
+	if(time_domain_head) time_domain_head->reset();
+	else fft_head->reset();
+	for(auto l: levels) l->reset();
+	if(output_ring) std::fill(output_ring, output_ring+output_ring_size, 0.0f);
+	ring_position = 0;
+}
+
+int NonuniformConvolver::getLevelCount() {
+	return levels.size();
+}
+
+int NonuniformConvolver::getResponseLength() {
+	return response_length;
+}
+
+}
@@ -0,0 +1,94 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/response_spectra.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <algorithm>
+
+namespace libaudioverse_implementation {
+
+//Until someone sets a response, pass the input through.
+static const float unit_impulse = 1.0f;
+
+PartitionedConvolver::PartitionedConvolver(int blockSize): PartitionedConvolver(blockSize, 1, &unit_impulse) {
+}
+
+PartitionedConvolver::PartitionedConvolver(int blockSize, int length, const float* response): block_size(blockSize) {
+	//The delay line moves a block at a time, so partitions are a block long.
+	//Overlap-save needs partition_size+block_size-1 <= fft_size; rounding up to a fast size only adds padding.
+	partition_size = block_size;
+	fft_size = getFftSize(2*block_size);
+	bin_count = fft_size/2+1;
+	//Keep every partition on its own cache lines.
+	stride = (bin_count+15)/16*16;
+	input_history = allocArray<float>(fft_size);
+	workspace = allocArray<float>(fft_size);
+	accumulator_real = allocArray<float>(stride);
+	accumulator_imag = allocArray<float>(stride);
+	fft = new Fft(fft_size);
+	setResponse(length, response);
+}
+
+PartitionedConvolver::~PartitionedConvolver() {
+	freeArray(input_history);
+	freeArray(workspace);
+	freeArray(accumulator_real);
+	freeArray(accumulator_imag);
+	if(delay_line_real) freeArray(delay_line_real);
+	if(delay_line_imag) freeArray(delay_line_imag);
+	delete fft;
+}
+
+void PartitionedConvolver::setResponse(int length, const float* response) {
+	//If anyone else has this response, this is free.
+	response_spectrum = getResponseSpectrum(fft_size, partition_size, length, response);
+	int newPartitionCount = response_spectrum->getPartitionCount();
+	if(newPartitionCount != partition_count) {
+		if(delay_line_real) freeArray(delay_line_real);
+		if(delay_line_imag) freeArray(delay_line_imag);
+		partition_count = newPartitionCount;
+		delay_line_real = allocArray<float>(stride*partition_count);
+		delay_line_imag = allocArray<float>(stride*partition_count);
+		reset();
+	}
+}
+
+void PartitionedConvolver::convolve(float* input, float* output) {
+	//Slide the input along by a block.
+	std::copy(input_history+block_size, input_history+fft_size, input_history);
+	std::copy(input, input+block_size, input_history+fft_size-block_size);
+	newest = newest == 0 ? partition_count-1 : newest-1;
+	fft->forward(input_history, delay_line_real+newest*stride, delay_line_imag+newest*stride);
+	//Partition i goes with the input from i blocks ago, which is i slots after the newest.
+	std::fill(accumulator_real, accumulator_real+bin_count, 0.0f);
+	std::fill(accumulator_imag, accumulator_imag+bin_count, 0.0f);
+	int slot = newest;
+	for(int i = 0; i < partition_count; i++) {
+		complexMultiplicationAdditionKernel(bin_count, delay_line_real+slot*stride, delay_line_imag+slot*stride,
+		response_spectrum->getReal(i), response_spectrum->getImag(i), accumulator_real, accumulator_imag);
+		slot = slot+1 == partition_count ? 0 : slot+1;
+	}
+	fft->inverse(accumulator_real, accumulator_imag, workspace);
+	//The end of the circular convolution is the only part without wraparound.
+	scalarMultiplicationKernel(block_size, 1.0f/fft_size, workspace+fft_size-block_size, output);
+}
+
+void PartitionedConvolver::reset() {
+	std::fill(input_history, input_history+fft_size, 0.0f);
+	std::fill(delay_line_real, delay_line_real+stride*partition_count, 0.0f);
+	std::fill(delay_line_imag, delay_line_imag+stride*partition_count, 0.0f);
+	newest = 0;
+}
+
+int PartitionedConvolver::getPartitionCount() {
+	return partition_count;
+}
+
+}
@@ -16,6 +16,10 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/logging.hpp>
 #include <libaudioverse/private/hrtf.hpp>
 #include <libaudioverse/private/initialization.hpp>
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/background_jobs.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/response_spectra.hpp>
 
 #include <atomic>
 
@@ -36,9 +40,13 @@ struct InitInfo {
 InitInfo initializers[] = {
 	//Logging is implicit.
 	{"Memory subsystem", initializeMemoryModule},
+	{"Kernels", initializeKernels},
+	{"FFT plan cache", initializeFft},
+	{"Background jobs", initializeBackgroundJobs},
 	{"Audio backend", initializeDeviceFactory},
 	{"Metadata tables", initializeMetadata},
 	{"HRTF caches", initializeHrtfCaches},
+	{"Response spectrum cache", initializeResponseSpectrumCache},
 };
 
 typedef void (*shutdownfunc_t)();
@@ -55,6 +63,10 @@ struct ShutdownInfo{
 //logging must always be last.
 ShutdownInfo shutdown_funcs[] = {
 	{"memory module", shutdownMemoryModule},
+	//After the memory module, so that everything which might submit a job is gone.
+	{"background jobs", shutdownBackgroundJobs},
+	{"FFT plan cache", shutdownFft},
+	{"response spectrum cache", shutdownResponseSpectrumCache},
 	//Device factory needs to go near the end because it tries to log.
 	{"audio backend", shutdownDeviceFactory},
 	{"HRTF caches", shutdownHrtfCaches},
@@ -8,6 +8,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 /**Implements addition kernel.*/
 #include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <mmintrin.h>
 #include <emmintrin.h>
@@ -25,7 +26,7 @@ void scalarAdditionKernelSimple(int length, float c, float* a1, float* dest) {
 
 #if defined(LIBAUDIOVERSE_USE_SSE2)
 
-void additionKernel(int length, float* a1, float* a2, float* dest) {
+void additionKernelSse2(int length, float* a1, float* a2, float* dest) {
 	int neededLength = (length/4)*4;
 	__m128 a1r, a2r;
 	for(int i = 0; i < neededLength; i+= 4) {
@@ -37,7 +38,7 @@ void additionKernel(int length, float* a1, float* a2, float* dest) {
 	additionKernelSimple(length-neededLength, a1+neededLength, a2+neededLength, dest+neededLength);
 }
 
-void scalarAdditionKernel(int length, float c, float* a1, float* dest) {
+void scalarAdditionKernelSse2(int length, float c, float* a1, float* dest) {
 	__m128 cr = _mm_load1_ps(&c);
 	int blocks = length/4;
 	for(int i = 0; i < blocks*4; i+=4) {
@@ -45,16 +46,7 @@ void scalarAdditionKernel(int length, float c, float* a1, float* dest) {
 		r1 = _mm_add_ps(r1, cr);
 		_mm_storeu_ps(dest+i, r1);
 	}
-	scalarAdditionKernelSimple(length-blocks*4, c, a1, dest);
-}
-
-#else
-void additionKernel(int length, float* a1, float* a2, float* dest) {
-	additionKernelSimple(length, a1, a2, dest);
-}
-
-void scalarAdditionKernel(int length, float c, float* a1, float* dest) {
-	scalarAdditionKernelSimple(length, c, a1, dest);
+	scalarAdditionKernelSimple(length-blocks*4, c, a1+blocks*4, dest+blocks*4);
 }
 
 #endif
@@ -0,0 +1,183 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**AVX2 and FMA versions of the dispatched kernels.
+This file is built with AVX2 enabled, so the compiler may use it anywhere in here. Only call these through kernel_table.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
+
+#if defined(LIBAUDIOVERSE_USE_AVX)
+#include <immintrin.h>
+
+namespace libaudioverse_implementation {
+
+void additionKernelAvx2(int length, float* a1, float* a2, float* dest) {
+	int neededLength = length/8*8;
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_add_ps(_mm256_loadu_ps(a1+i), _mm256_loadu_ps(a2+i)));
+	}
+	additionKernelSimple(length-neededLength, a1+neededLength, a2+neededLength, dest+neededLength);
+}
+
+void scalarAdditionKernelAvx2(int length, float c, float* a1, float* dest) {
+	int neededLength = length/8*8;
+	__m256 cr = _mm256_set1_ps(c);
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_add_ps(_mm256_loadu_ps(a1+i), cr));
+	}
+	scalarAdditionKernelSimple(length-neededLength, c, a1+neededLength, dest+neededLength);
+}
+
+void scalarMultiplicationKernelAvx2(int length, float c, float* a1, float* dest) {
+	int neededLength = length/8*8;
+	__m256 cr = _mm256_set1_ps(c);
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_mul_ps(_mm256_loadu_ps(a1+i), cr));
+	}
+	scalarMultiplicationKernelSimple(length-neededLength, c, a1+neededLength, dest+neededLength);
+}
+
+void multiplicationKernelAvx2(int length, float* a1, float* a2, float* dest) {
+	int neededLength = length/8*8;
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_mul_ps(_mm256_loadu_ps(a1+i), _mm256_loadu_ps(a2+i)));
+	}
+	multiplicationKernelSimple(length-neededLength, a1+neededLength, a2+neededLength, dest+neededLength);
+}
+
+void multiplicationAdditionKernelAvx2(int length, float c, float* a1, float* a2, float* dest) {
+	int neededLength = length/8*8;
+	__m256 cr = _mm256_set1_ps(c);
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_fmadd_ps(_mm256_loadu_ps(a1+i), cr, _mm256_loadu_ps(a2+i)));
+	}
+	multiplicationAdditionKernelSimple(length-neededLength, c, a1+neededLength, a2+neededLength, dest+neededLength);
+}
+
+void arrayMultiplicationAdditionKernelAvx2(int length, float* a1, float* mul, float* add, float* dest) {
+	int neededLength = length/8*8;
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_fmadd_ps(_mm256_loadu_ps(a1+i), _mm256_loadu_ps(mul+i), _mm256_loadu_ps(add+i)));
+	}
+	arrayMultiplicationAdditionKernelSimple(length-neededLength, a1+neededLength, mul+neededLength, add+neededLength, dest+neededLength);
+}
+
+void multiplicationScalarAdditionKernelAvx2(int length, float* a1, float* mul, float c, float* dest) {
+	int neededLength = length/8*8;
+	__m256 cr = _mm256_set1_ps(c);
+	for(int i = 0; i < neededLength; i += 8) {
+		_mm256_storeu_ps(dest+i, _mm256_fmadd_ps(_mm256_loadu_ps(a1+i), _mm256_loadu_ps(mul+i), cr));
+	}
+	multiplicationScalarAdditionKernelSimple(length-neededLength, a1+neededLength, mul+neededLength, c, dest+neededLength);
+}
+
+void parallelMultiplicationAdditionKernelAvx2(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
+	__m256 c1r = _mm256_set1_ps(c1);
+	__m256 c2r = _mm256_set1_ps(c2);
+	__m256 c3r = _mm256_set1_ps(c3);
+	__m256 c4r = _mm256_set1_ps(c4);
+	int needed = length/8*8;
+	for(int i = 0; i < needed; i += 8) {
+		//Two chains, so that the FMAs don't all wait on each other.
+		__m256 first = _mm256_fmadd_ps(_mm256_loadu_ps(a1+i), c1r, _mm256_loadu_ps(a2+i));
+		__m256 second = _mm256_mul_ps(_mm256_loadu_ps(a1+i+1), c2r);
+		first = _mm256_fmadd_ps(_mm256_loadu_ps(a1+i+2), c3r, first);
+		second = _mm256_fmadd_ps(_mm256_loadu_ps(a1+i+3), c4r, second);
+		_mm256_storeu_ps(out+i, _mm256_add_ps(first, second));
+	}
+	parallelMultiplicationAdditionKernelSimple(length-needed, c1, c2, c3, c4, a1+needed, a2+needed, out+needed);
+}
+
+float dotKernelAvx2(int length, const float* v1, const float* v2) {
+	__m256 accum1 = _mm256_setzero_ps(), accum2 = _mm256_setzero_ps();
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		accum1 = _mm256_fmadd_ps(_mm256_loadu_ps(v1+i), _mm256_loadu_ps(v2+i), accum1);
+		accum2 = _mm256_fmadd_ps(_mm256_loadu_ps(v1+i+8), _mm256_loadu_ps(v2+i+8), accum2);
+	}
+	if(i+8 <= length) {
+		accum1 = _mm256_fmadd_ps(_mm256_loadu_ps(v1+i), _mm256_loadu_ps(v2+i), accum1);
+		i += 8;
+	}
+	accum1 = _mm256_add_ps(accum1, accum2);
+	//Fold to 4, then the same horizontal sum as the SSE2 version.
+	__m128 accum = _mm_add_ps(_mm256_castps256_ps128(accum1), _mm256_extractf128_ps(accum1, 1));
+	accum = _mm_add_ps(accum, _mm_movehl_ps(accum, accum));
+	accum = _mm_add_ss(accum, _mm_shuffle_ps(accum, accum, 1));
+	return _mm_cvtss_f32(accum)+dotKernelSimple(length-i, v1+i, v2+i);
+}
+
+void complexMultiplicationAdditionKernelAvx2(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag) {
+	int neededLength = length/8*8;
+	for(int i = 0; i < neededLength; i += 8) {
+		__m256 ar = _mm256_loadu_ps(aReal+i), ai = _mm256_loadu_ps(aImag+i);
+		__m256 br = _mm256_loadu_ps(bReal+i), bi = _mm256_loadu_ps(bImag+i);
+		__m256 real = _mm256_fmadd_ps(ar, br, _mm256_loadu_ps(destReal+i));
+		__m256 imag = _mm256_fmadd_ps(ar, bi, _mm256_loadu_ps(destImag+i));
+		_mm256_storeu_ps(destReal+i, _mm256_fnmadd_ps(ai, bi, real));
+		_mm256_storeu_ps(destImag+i, _mm256_fmadd_ps(ai, br, imag));
+	}
+	complexMultiplicationAdditionKernelSimple(length-neededLength, aReal+neededLength, aImag+neededLength, bReal+neededLength, bImag+neededLength, destReal+neededLength, destImag+neededLength);
+}
+
+//Only stereo is worth doing specially; it's what almost every device wants.
+void interleaveSamplesAvx2(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output) {
+	if(channels != 2 || inputCount < 2) {
+		interleaveSamplesSimple(channels, frames, inputCount, inputs, output);
+		return;
+	}
+	float* left = inputs[0], *right = inputs[1];
+	unsigned int needed = frames/8*8;
+	for(unsigned int i = 0; i < needed; i += 8) {
+		__m256 l = _mm256_loadu_ps(left+i), r = _mm256_loadu_ps(right+i);
+		//Unpacking works within 128-bit lanes: low is frames 0, 1, 4, 5 and high is 2, 3, 6, 7.
+		__m256 low = _mm256_unpacklo_ps(l, r), high = _mm256_unpackhi_ps(l, r);
+		_mm256_storeu_ps(output+2*i, _mm256_permute2f128_ps(low, high, 0x20));
+		_mm256_storeu_ps(output+2*i+8, _mm256_permute2f128_ps(low, high, 0x31));
+	}
+	float* rest[] = {left+needed, right+needed};
+	interleaveSamplesSimple(2, frames-needed, 2, rest, output+2*needed);
+}
+
+void uninterleaveSamplesAvx2(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs) {
+	if(channels != 2 || outputCount < 2) {
+		uninterleaveSamplesSimple(channels, frames, samples, outputCount, outputs);
+		return;
+	}
+	float* left = outputs[0], *right = outputs[1];
+	unsigned int needed = frames/8*8;
+	for(unsigned int i = 0; i < needed; i += 8) {
+		__m256 a = _mm256_loadu_ps(samples+2*i), b = _mm256_loadu_ps(samples+2*i+8);
+		//Within lanes, this gives frames 0, 1, 4, 5 and 2, 3, 6, 7; swapping the middle pairs puts them in order.
+		__m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		__m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		_mm256_storeu_ps(left+i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+		_mm256_storeu_ps(right+i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+	}
+	float* rest[] = {left+needed, right+needed};
+	uninterleaveSamplesSimple(2, frames-needed, samples+2*needed, 2, rest);
+}
+
+void installAvx2Kernels(KernelTable &table) {
+	table.uninterleave = uninterleaveSamplesAvx2;
+	table.interleave = interleaveSamplesAvx2;
+	table.addition = additionKernelAvx2;
+	table.scalarAddition = scalarAdditionKernelAvx2;
+	table.scalarMultiplication = scalarMultiplicationKernelAvx2;
+	table.multiplication = multiplicationKernelAvx2;
+	table.multiplicationAddition = multiplicationAdditionKernelAvx2;
+	table.arrayMultiplicationAddition = arrayMultiplicationAdditionKernelAvx2;
+	table.multiplicationScalarAddition = multiplicationScalarAdditionKernelAvx2;
+	table.parallelMultiplicationAddition = parallelMultiplicationAdditionKernelAvx2;
+	table.dot = dotKernelAvx2;
+	table.complexMultiplicationAddition = complexMultiplicationAdditionKernelAvx2;
+}
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**AVX-512 versions of the dispatched kernels.
+This file is built with AVX-512F enabled, so the compiler may use it anywhere in here. Only call these through kernel_table.
+Leftovers use masked loads and stores instead of falling back to the simple kernels.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
+
+#if defined(LIBAUDIOVERSE_USE_AVX)
+#include <immintrin.h>
+
+namespace libaudioverse_implementation {
+
+//The lanes a tail of remaining floats covers. remaining must be below 16.
+inline __mmask16 tailMask(int remaining) {
+	return (__mmask16)((1u << remaining)-1);
+}
+
+void additionKernelAvx512(int length, float* a1, float* a2, float* dest) {
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_add_ps(_mm512_loadu_ps(a1+i), _mm512_loadu_ps(a2+i)));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, a1+i), _mm512_maskz_loadu_ps(m, a2+i)));
+}
+
+void scalarAdditionKernelAvx512(int length, float c, float* a1, float* dest) {
+	__m512 cr = _mm512_set1_ps(c);
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_add_ps(_mm512_loadu_ps(a1+i), cr));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, a1+i), cr));
+}
+
+void scalarMultiplicationKernelAvx512(int length, float c, float* a1, float* dest) {
+	__m512 cr = _mm512_set1_ps(c);
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_mul_ps(_mm512_loadu_ps(a1+i), cr));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a1+i), cr));
+}
+
+void multiplicationKernelAvx512(int length, float* a1, float* a2, float* dest) {
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_mul_ps(_mm512_loadu_ps(a1+i), _mm512_loadu_ps(a2+i)));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a1+i), _mm512_maskz_loadu_ps(m, a2+i)));
+}
+
+void multiplicationAdditionKernelAvx512(int length, float c, float* a1, float* a2, float* dest) {
+	__m512 cr = _mm512_set1_ps(c);
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_fmadd_ps(_mm512_loadu_ps(a1+i), cr, _mm512_loadu_ps(a2+i)));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1+i), cr, _mm512_maskz_loadu_ps(m, a2+i)));
+}
+
+void arrayMultiplicationAdditionKernelAvx512(int length, float* a1, float* mul, float* add, float* dest) {
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_fmadd_ps(_mm512_loadu_ps(a1+i), _mm512_loadu_ps(mul+i), _mm512_loadu_ps(add+i)));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1+i), _mm512_maskz_loadu_ps(m, mul+i), _mm512_maskz_loadu_ps(m, add+i)));
+}
+
+void multiplicationScalarAdditionKernelAvx512(int length, float* a1, float* mul, float c, float* dest) {
+	__m512 cr = _mm512_set1_ps(c);
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		_mm512_storeu_ps(dest+i, _mm512_fmadd_ps(_mm512_loadu_ps(a1+i), _mm512_loadu_ps(mul+i), cr));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	_mm512_mask_storeu_ps(dest+i, m, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1+i), _mm512_maskz_loadu_ps(m, mul+i), cr));
+}
+
+void parallelMultiplicationAdditionKernelAvx512(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
+	__m512 c1r = _mm512_set1_ps(c1);
+	__m512 c2r = _mm512_set1_ps(c2);
+	__m512 c3r = _mm512_set1_ps(c3);
+	__m512 c4r = _mm512_set1_ps(c4);
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		__m512 first = _mm512_fmadd_ps(_mm512_loadu_ps(a1+i), c1r, _mm512_loadu_ps(a2+i));
+		__m512 second = _mm512_mul_ps(_mm512_loadu_ps(a1+i+1), c2r);
+		first = _mm512_fmadd_ps(_mm512_loadu_ps(a1+i+2), c3r, first);
+		second = _mm512_fmadd_ps(_mm512_loadu_ps(a1+i+3), c4r, second);
+		_mm512_storeu_ps(out+i, _mm512_add_ps(first, second));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	__m512 first = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1+i), c1r, _mm512_maskz_loadu_ps(m, a2+i));
+	__m512 second = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a1+i+1), c2r);
+	first = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1+i+2), c3r, first);
+	second = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1+i+3), c4r, second);
+	_mm512_mask_storeu_ps(out+i, m, _mm512_add_ps(first, second));
+}
+
+float dotKernelAvx512(int length, const float* v1, const float* v2) {
+	__m512 accum1 = _mm512_setzero_ps(), accum2 = _mm512_setzero_ps();
+	int i = 0;
+	for(; i+32 <= length; i += 32) {
+		accum1 = _mm512_fmadd_ps(_mm512_loadu_ps(v1+i), _mm512_loadu_ps(v2+i), accum1);
+		accum2 = _mm512_fmadd_ps(_mm512_loadu_ps(v1+i+16), _mm512_loadu_ps(v2+i+16), accum2);
+	}
+	if(i+16 <= length) {
+		accum1 = _mm512_fmadd_ps(_mm512_loadu_ps(v1+i), _mm512_loadu_ps(v2+i), accum1);
+		i += 16;
+	}
+	if(i < length) {
+		__mmask16 m = tailMask(length-i);
+		accum2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, v1+i), _mm512_maskz_loadu_ps(m, v2+i), accum2);
+	}
+	return _mm512_reduce_add_ps(_mm512_add_ps(accum1, accum2));
+}
+
+void complexMultiplicationAdditionKernelAvx512(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag) {
+	int i = 0;
+	for(; i+16 <= length; i += 16) {
+		__m512 ar = _mm512_loadu_ps(aReal+i), ai = _mm512_loadu_ps(aImag+i);
+		__m512 br = _mm512_loadu_ps(bReal+i), bi = _mm512_loadu_ps(bImag+i);
+		__m512 real = _mm512_fmadd_ps(ar, br, _mm512_loadu_ps(destReal+i));
+		__m512 imag = _mm512_fmadd_ps(ar, bi, _mm512_loadu_ps(destImag+i));
+		_mm512_storeu_ps(destReal+i, _mm512_fnmadd_ps(ai, bi, real));
+		_mm512_storeu_ps(destImag+i, _mm512_fmadd_ps(ai, br, imag));
+	}
+	if(i == length) return;
+	__mmask16 m = tailMask(length-i);
+	__m512 ar = _mm512_maskz_loadu_ps(m, aReal+i), ai = _mm512_maskz_loadu_ps(m, aImag+i);
+	__m512 br = _mm512_maskz_loadu_ps(m, bReal+i), bi = _mm512_maskz_loadu_ps(m, bImag+i);
+	__m512 real = _mm512_fmadd_ps(ar, br, _mm512_maskz_loadu_ps(m, destReal+i));
+	__m512 imag = _mm512_fmadd_ps(ar, bi, _mm512_maskz_loadu_ps(m, destImag+i));
+	_mm512_mask_storeu_ps(destReal+i, m, _mm512_fnmadd_ps(ai, bi, real));
+	_mm512_mask_storeu_ps(destImag+i, m, _mm512_fmadd_ps(ai, br, imag));
+}
+
+void interleaveSamplesAvx512(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output) {
+	if(channels != 2 || inputCount < 2) {
+		interleaveSamplesSimple(channels, frames, inputCount, inputs, output);
+		return;
+	}
+	//Indices 16 and up come from the right channel.
+	const __m512i low_indices = _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4, 19, 3, 18, 2, 17, 1, 16, 0);
+	const __m512i high_indices = _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12, 27, 11, 26, 10, 25, 9, 24, 8);
+	float* left = inputs[0], *right = inputs[1];
+	unsigned int needed = frames/16*16;
+	for(unsigned int i = 0; i < needed; i += 16) {
+		__m512 l = _mm512_loadu_ps(left+i), r = _mm512_loadu_ps(right+i);
+		_mm512_storeu_ps(output+2*i, _mm512_permutex2var_ps(l, low_indices, r));
+		_mm512_storeu_ps(output+2*i+16, _mm512_permutex2var_ps(l, high_indices, r));
+	}
+	float* rest[] = {left+needed, right+needed};
+	interleaveSamplesSimple(2, frames-needed, 2, rest, output+2*needed);
+}
+
+void uninterleaveSamplesAvx512(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs) {
+	if(channels != 2 || outputCount < 2) {
+		uninterleaveSamplesSimple(channels, frames, samples, outputCount, outputs);
+		return;
+	}
+	const __m512i even_indices = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+	const __m512i odd_indices = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+	float* left = outputs[0], *right = outputs[1];
+	unsigned int needed = frames/16*16;
+	for(unsigned int i = 0; i < needed; i += 16) {
+		__m512 a = _mm512_loadu_ps(samples+2*i), b = _mm512_loadu_ps(samples+2*i+16);
+		_mm512_storeu_ps(left+i, _mm512_permutex2var_ps(a, even_indices, b));
+		_mm512_storeu_ps(right+i, _mm512_permutex2var_ps(a, odd_indices, b));
+	}
+	float* rest[] = {left+needed, right+needed};
+	uninterleaveSamplesSimple(2, frames-needed, samples+2*needed, 2, rest);
+}
+
+void installAvx512Kernels(KernelTable &table) {
+	table.uninterleave = uninterleaveSamplesAvx512;
+	table.interleave = interleaveSamplesAvx512;
+	table.addition = additionKernelAvx512;
+	table.scalarAddition = scalarAdditionKernelAvx512;
+	table.scalarMultiplication = scalarMultiplicationKernelAvx512;
+	table.multiplication = multiplicationKernelAvx512;
+	table.multiplicationAddition = multiplicationAdditionKernelAvx512;
+	table.arrayMultiplicationAddition = arrayMultiplicationAdditionKernelAvx512;
+	table.multiplicationScalarAddition = multiplicationScalarAdditionKernelAvx512;
+	table.parallelMultiplicationAddition = parallelMultiplicationAdditionKernelAvx512;
+	table.dot = dotKernelAvx512;
+	table.complexMultiplicationAddition = complexMultiplicationAdditionKernelAvx512;
+}
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Implements complex multiply-accumulate on split spectra.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace libaudioverse_implementation {
+
+void complexMultiplicationAdditionKernelSimple(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag) {
+	for(int i = 0; i < length; i++) {
+		destReal[i] += aReal[i]*bReal[i]-aImag[i]*bImag[i];
+		destImag[i] += aReal[i]*bImag[i]+aImag[i]*bReal[i];
+	}
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void complexMultiplicationAdditionKernelSse2(int length, float* aReal, float* aImag, float* bReal, float* bImag, float* destReal, float* destImag) {
+	int neededLength = length/4*4;
+	for(int i = 0; i < neededLength; i += 4) {
+		__m128 ar = _mm_loadu_ps(aReal+i), ai = _mm_loadu_ps(aImag+i);
+		__m128 br = _mm_loadu_ps(bReal+i), bi = _mm_loadu_ps(bImag+i);
+		__m128 real = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+		__m128 imag = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+		_mm_storeu_ps(destReal+i, _mm_add_ps(_mm_loadu_ps(destReal+i), real));
+		_mm_storeu_ps(destImag+i, _mm_add_ps(_mm_loadu_ps(destImag+i), imag));
+	}
+	complexMultiplicationAdditionKernelSimple(length-neededLength, aReal+neededLength, aImag+neededLength, bReal+neededLength, bImag+neededLength, destReal+neededLength, destImag+neededLength);
+}
+
+#endif
+
+}
@@ -0,0 +1,42 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Implements conversions between sample formats.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace libaudioverse_implementation {
+
+void doubleToFloatKernelSimple(int length, double* source, float* dest) {
+	for(int i = 0; i < length; i++) dest[i] = (float)source[i];
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void doubleToFloatKernel(int length, double* source, float* dest) {
+	int neededLength = (length/4)*4;
+	for(int i = 0; i < neededLength; i+=4) {
+		__m128 low = _mm_cvtpd_ps(_mm_loadu_pd(source+i));
+		__m128 high = _mm_cvtpd_ps(_mm_loadu_pd(source+i+2));
+		_mm_storeu_ps(dest+i, _mm_movelh_ps(low, high));
+	}
+	doubleToFloatKernelSimple(length-neededLength, source+neededLength, dest+neededLength);
+}
+
+#else
+
+void doubleToFloatKernel(int length, double* source, float* dest) {
+	doubleToFloatKernelSimple(length, source, dest);
+}
+
+#endif
+
+}
@@ -0,0 +1,122 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Picks kernels for the CPU we're running on.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
+#include <libaudioverse/private/logging.hpp>
+#if defined(LIBAUDIOVERSE_USE_AVX)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace libaudioverse_implementation {
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+KernelTable kernel_table = {
+	uninterleaveSamplesSimple,
+	interleaveSamplesSimple,
+	additionKernelSse2,
+	scalarAdditionKernelSse2,
+	scalarMultiplicationKernelSse2,
+	multiplicationKernelSse2,
+	multiplicationAdditionKernelSse2,
+	arrayMultiplicationAdditionKernelSse2,
+	multiplicationScalarAdditionKernelSse2,
+	parallelMultiplicationAdditionKernelSse2,
+	dotKernelSse2,
+	complexMultiplicationAdditionKernelSse2,
+};
+const char* kernel_instruction_set = "SSE2";
+#else
+KernelTable kernel_table = {
+	uninterleaveSamplesSimple,
+	interleaveSamplesSimple,
+	additionKernelSimple,
+	scalarAdditionKernelSimple,
+	scalarMultiplicationKernelSimple,
+	multiplicationKernelSimple,
+	multiplicationAdditionKernelSimple,
+	arrayMultiplicationAdditionKernelSimple,
+	multiplicationScalarAdditionKernelSimple,
+	parallelMultiplicationAdditionKernelSimple,
+	dotKernelSimple,
+	complexMultiplicationAdditionKernelSimple,
+};
+const char* kernel_instruction_set = "none";
+#endif
+
+#if defined(LIBAUDIOVERSE_USE_AVX)
+
+//regs is eax, ebx, ecx, edx.
+void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int* regs) {
+	#if defined(_MSC_VER)
+	__cpuidex((int*)regs, leaf, subleaf);
+	#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+	#endif
+}
+
+//Which register states the OS saves on context switches. A CPU can have AVX and still not let us use it.
+unsigned long long getEnabledStates() {
+	#if defined(_MSC_VER)
+	return _xgetbv(0);
+	#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+	#endif
+}
+
+void detectInstructionSets(bool &avx2, bool &avx512) {
+	avx2 = avx512 = false;
+	unsigned int regs[4];
+	cpuid(0, 0, regs);
+	if(regs[0] < 7) return;
+	cpuid(1, 0, regs);
+	bool fma = regs[2] & (1 << 12);
+	bool osxsave = regs[2] & (1 << 27);
+	bool avx = regs[2] & (1 << 28);
+	if(osxsave == false || avx == false) return;
+	auto states = getEnabledStates();
+	//SSE and AVX state, then the AVX-512 opmask and upper register states.
+	bool os_avx = (states & 0x6) == 0x6;
+	bool os_avx512 = (states & 0xe6) == 0xe6;
+	cpuid(7, 0, regs);
+	bool has_avx2 = regs[1] & (1 << 5);
+	bool has_avx512f = regs[1] & (1 << 16);
+	avx2 = os_avx && has_avx2 && fma;
+	avx512 = avx2 && os_avx512 && has_avx512f;
+}
+
+#endif
+
+void initializeKernels() {
+	#if defined(LIBAUDIOVERSE_USE_AVX)
+	bool avx2, avx512;
+	detectInstructionSets(avx2, avx512);
+	if(avx512) {
+		installAvx512Kernels(kernel_table);
+		kernel_instruction_set = "AVX-512";
+	}
+	else if(avx2) {
+		installAvx2Kernels(kernel_table);
+		kernel_instruction_set = "AVX2";
+	}
+	#endif
+	logInfo("Using %s kernels.", kernel_instruction_set);
+}
+
+const char* getKernelInstructionSet() {
+	return kernel_instruction_set;
+}
+
+}
@@ -8,6 +8,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 /**Implements addition kernel.*/
 #include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <mmintrin.h>
 #include <emmintrin.h>
@@ -23,7 +24,7 @@ float dotKernelSimple(int length, const float* v1, const float* v2) {
 
 #if defined(LIBAUDIOVERSE_USE_SSE2)
 
-float dotKernel(int length, const float* v1, const float* v2) {
+float dotKernelSse2(int length, const float* v1, const float* v2) {
 	__m128 accum = _mm_setzero_ps();
 	float result = 0.0f;
 	for(int i= 0; i < length/4*4; i+=4) {
@@ -45,12 +46,6 @@ float dotKernel(int length, const float* v1, const float* v2) {
 	return result+tmp;
 }
 
-#else
-
-float dotKernel(int length, const float* v1, const float* v2) {
-	return dotKernelSimple(length, v1, v2);
-}
-
 #endif
 
 
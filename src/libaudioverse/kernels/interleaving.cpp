@@ -8,13 +8,14 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 /**Knows how to take individual channels and combine them into an output buffer, or perform the inverse: separate a buffer of interleaved samples into individual buffers.*/
 #include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
 #include <stdlib.h>
 #include <string.h>
 #include <algorithm>
 
 namespace libaudioverse_implementation {
 
-void uninterleaveSamples(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs) {
+void uninterleaveSamplesSimple(unsigned int channels, unsigned int frames, float* samples, unsigned int outputCount, float** outputs) {
 	for(unsigned int i = 0; i < channels; i++) {
 		if(i >= outputCount) break;
 		for(unsigned int j = 0; j < frames; j++) {
@@ -23,7 +24,7 @@ void uninterleaveSamples(unsigned int channels, unsigned int frames, float* samp
 	}
 }
 
-void interleaveSamples(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output) {
+void interleaveSamplesSimple(unsigned int channels, unsigned int frames, unsigned int inputCount, float** inputs, float* output) {
 	for(unsigned int i = 0; i < channels; i++) {
 		for(unsigned int j = 0; j < frames; j++) {
 			output[j*channels+i] = i >= inputCount ? 0.0f : inputs[i][j];
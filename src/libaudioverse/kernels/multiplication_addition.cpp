@@ -8,6 +8,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 /**Implements multiplication kernel and vairiants.*/
 #include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <mmintrin.h>
 #include <emmintrin.h>
@@ -20,6 +21,14 @@ void multiplicationAdditionKernelSimple(int length, float c, float* a1, float *a
 }
 
 
+void arrayMultiplicationAdditionKernelSimple(int length, float* a1, float* mul, float* add, float* dest) {
+	for(int i = 0; i < length; i++) dest[i] = a1[i]*mul[i]+add[i];
+}
+
+void multiplicationScalarAdditionKernelSimple(int length, float* a1, float* mul, float c, float* dest) {
+	for(int i = 0; i < length; i++) dest[i] = a1[i]*mul[i]+c;
+}
+
 void parallelMultiplicationAdditionKernelSimple(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
 	float *a11 = a1, *a12 = a1+1, *a13 = a1+2, *a14 = a1+3;
 	for(int i = 0; i < length; i++) {
@@ -29,7 +38,7 @@ void parallelMultiplicationAdditionKernelSimple(int length, float c1, float c2,
 
 #if defined(LIBAUDIOVERSE_USE_SSE2)
 
-void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, float* dest) {
+void multiplicationAdditionKernelSse2(int length, float c, float* a1, float* a2, float* dest) {
 	int neededLength = (length/4)*4;
 	__m128 cr = _mm_load1_ps(&c);
 	for(int i = 0; i < neededLength; i+=4) {
@@ -42,7 +51,29 @@ void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, flo
 	multiplicationAdditionKernelSimple(length-neededLength, c, a1+neededLength, a2+neededLength, dest+neededLength);
 }
 
-void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
+void arrayMultiplicationAdditionKernelSse2(int length, float* a1, float* mul, float* add, float* dest) {
+	int neededLength = (length/4)*4;
+	for(int i = 0; i < neededLength; i+=4) {
+		__m128 a1r = _mm_loadu_ps(a1+i);
+		__m128 mulr = _mm_loadu_ps(mul+i);
+		__m128 addr = _mm_loadu_ps(add+i);
+		_mm_storeu_ps(dest+i, _mm_add_ps(_mm_mul_ps(a1r, mulr), addr));
+	}
+	arrayMultiplicationAdditionKernelSimple(length-neededLength, a1+neededLength, mul+neededLength, add+neededLength, dest+neededLength);
+}
+
+void multiplicationScalarAdditionKernelSse2(int length, float* a1, float* mul, float c, float* dest) {
+	int neededLength = (length/4)*4;
+	__m128 cr = _mm_load1_ps(&c);
+	for(int i = 0; i < neededLength; i+=4) {
+		__m128 a1r = _mm_loadu_ps(a1+i);
+		__m128 mulr = _mm_loadu_ps(mul+i);
+		_mm_storeu_ps(dest+i, _mm_add_ps(_mm_mul_ps(a1r, mulr), cr));
+	}
+	multiplicationScalarAdditionKernelSimple(length-neededLength, a1+neededLength, mul+neededLength, c, dest+neededLength);
+}
+
+void parallelMultiplicationAdditionKernelSse2(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
 	__m128 c1r = _mm_set1_ps(c1);
 	__m128 c2r = _mm_set1_ps(c2);
 	__m128 c3r = _mm_set1_ps(c3);
@@ -68,16 +99,6 @@ void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float
 	parallelMultiplicationAdditionKernelSimple(length-needed, c1, c2, c3, c4, a1+needed, a2+needed, out+needed);
 }
 
-#else
-
-void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, float* dest) {
-	multiplicationAdditionKernelSimple(length, c, a1, a2, dest);
-}
-
-void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
-	parallelMultiplicationKernelSimple(length, c1, c2, c3, c4, a1, a2, out);
-}
-
 #endif
 
 }
\ No newline at end of file
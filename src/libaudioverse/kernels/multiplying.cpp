@@ -8,6 +8,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 /**Implements multiplication kernel and vairiants.*/
 #include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/kernel_variants.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <mmintrin.h>
 #include <emmintrin.h>
@@ -24,7 +25,7 @@ void scalarMultiplicationKernelSimple(int length, float c, float* a1, float* des
 }
 
 #if defined(LIBAUDIOVERSE_USE_SSE2)
-void multiplicationKernel(int length, float* a1, float* a2, float* dest) {
+void multiplicationKernelSse2(int length, float* a1, float* a2, float* dest) {
 	int neededLength = (length/4)*4;
 	__m128 a1r, a2r;
 	for(int i = 0; i < neededLength; i+= 4) {
@@ -36,7 +37,7 @@ void multiplicationKernel(int length, float* a1, float* a2, float* dest) {
 	multiplicationKernelSimple(length-neededLength, a1+neededLength, a2+neededLength, dest+neededLength);
 }
 
-void scalarMultiplicationKernel(int length, float c, float* a1, float* dest) {
+void scalarMultiplicationKernelSse2(int length, float c, float* a1, float* dest) {
 	int neededLength = (length/4)*4;
 	__m128 a1r, cr;
 	cr = _mm_load1_ps(&c);
@@ -48,15 +49,6 @@ void scalarMultiplicationKernel(int length, float c, float* a1, float* dest) {
 	scalarMultiplicationKernelSimple(length-neededLength, c, a1+neededLength, dest+neededLength);
 }
 
-#else
-void multiplicationKernel(int length, float* a1, float* a2, float* dest) {
-	multiplicationKernelSimple(length, a1, a2, dest);
-}
-
-void scalarMultiplicationKernel(int length, float c, float* a1, float*dest) {
-	scalarMultiplicationKernelSimple(length, c, a1, dest);
-}
-
 #endif
 
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Implements the ramp kernel, used to render automation.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace libaudioverse_implementation {
+
+void rampKernelSimple(int length, double start, double step, double* dest) {
+	for(int i = 0; i < length; i++) dest[i] = start+i*step;
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void rampKernel(int length, double start, double step, double* dest) {
+	int neededLength = (length/2)*2;
+	//Compute from the index rather than accumulating, so that error doesn't build up over long blocks.
+	__m128d startr = _mm_set1_pd(start);
+	__m128d stepr = _mm_set1_pd(step);
+	__m128d indices = _mm_set_pd(1.0, 0.0);
+	__m128d two = _mm_set1_pd(2.0);
+	for(int i = 0; i < neededLength; i+=2) {
+		_mm_storeu_pd(dest+i, _mm_add_pd(startr, _mm_mul_pd(indices, stepr)));
+		indices = _mm_add_pd(indices, two);
+	}
+	rampKernelSimple(length-neededLength, start+neededLength*step, step, dest+neededLength);
+}
+
+#else
+
+void rampKernel(int length, double start, double step, double* dest) {
+	rampKernelSimple(length, start, step, dest);
+}
+
+#endif
+
+}
@@ -25,22 +25,16 @@ namespace libaudioverse_implementation {
 
 std::map<void*, std::shared_ptr<void>> *external_ptrs = nullptr;
 std::recursive_mutex *memory_lock = nullptr;
-//The handles we keep alive because the external world has a copy.
-std::map<int, std::shared_ptr<ExternalObject>> *external_handles = nullptr;
-//Sometimes, the external world has handed in all its references.  But we need to be able to look it up anyway, in case we haven't deleted it.
-//This dict holds a weak reference to every handle passed to the external world until the end of the program.
-std::map<int, std::weak_ptr<ExternalObject>> *weak_external_handles = nullptr;
-std::atomic<int> *max_handle = nullptr;
+//Holds strong references to the objects the external world has handles to, and weak references to everything we've ever passed out so that handles keep working for as long as their objects live.
+HandleTable *handle_table = nullptr;
 LavHandleDestroyedCallback handle_destroyed_callback = nullptr;
 bool memory_initialized = false;
 
 void initializeMemoryModule() {
 	memory_lock=new std::recursive_mutex();
-	max_handle = new std::atomic<int>();
-	max_handle->store(1);
+	//Objects can outlive shutdown and release their handles afterwords, so the table is never freed and is reused if we initialize again.
+	if(handle_table == nullptr) handle_table = new HandleTable();
 	external_ptrs= new std::map<void*, std::shared_ptr<void>>();
-	external_handles=new std::map<int, std::shared_ptr<ExternalObject>>();
-	weak_external_handles = new std::map<int, std::weak_ptr<ExternalObject>>();
 	memory_initialized = true;
 }
 
@@ -54,32 +48,29 @@ void shutdownMemoryModule() {
 	//In addition, servers hold devices which may be in the middle of processing.
 	//In this case, the server needs to be isolated here--if we don't, we can abandon its pointer while it's still running.
 	//This additionally results in a running thread that we never join.
-	for(auto &i: *weak_external_handles) {
-		auto obj = i.second.lock();
+	auto objects = handle_table->getLiveObjects();
+	for(auto &obj: objects) {
 		keepAlive.push_back(obj);
 		auto s = std::dynamic_pointer_cast<Server>(obj);
 		if(s) {
 			s->lock();
 		}
 	}
-	for(auto &i: *weak_external_handles) {
-		auto obj = i.second.lock();
+	for(auto &obj: objects) {
 		auto n = std::dynamic_pointer_cast<Node>(obj);
 		if(n) n->isolate();
 	}
-	for(auto &i: *weak_external_handles) {
-		auto obj = i.second.lock();
+	for(auto &obj: objects) {
 		auto s= std::dynamic_pointer_cast<Server>(obj);
-		if(s) s->unlock();
+		if(s) {
+			//Isolation only published the disconnections; make them take effect so the snapshots let go of the nodes.
+			s->applyTopologyCommits();
+			s->unlock();
+		}
 	}
-	delete external_handles;
-	external_handles = nullptr;
-	delete weak_external_handles;
-	weak_external_handles = nullptr;
+	handle_table->dropAllStrongReferences();
 	delete external_ptrs;
 	external_ptrs = nullptr;
-	delete max_handle;
-	max_handle = nullptr;
 	//We intensionally leak the memory lock.
 	//This has to stay around so that the public API can be made safe after library shutdown.
 	//User code won't call us, but garbage collected languages might.
@@ -92,14 +83,14 @@ void shutdownMemoryModule() {
 }
 
 ExternalObject::ExternalObject(int type) {
-	external_object_handle = max_handle->fetch_add(1);
+	external_object_handle = handle_table->allocate();
 	this->type=type;
 	refcount.store(0);
 }
 
 ExternalObject::~ExternalObject() {
 	//We can't call the handleDestroyedCallback here, if we do we're inside a lock.
-	//This is here because the ExternalObject constructor is virtual and this used to contain code (and might again).
+	handle_table->release(external_object_handle);
 }
 
 int ExternalObject::getType() {
@@ -126,19 +117,26 @@ bool isAligned(const void* ptr) {
 	#endif
 }
 
+void destroyExternalObject(Server* server, ExternalObject* obj) {
+	//We have to make sure to call the callback outside the lock.
+	//To that end, we gather information as follows, and then queue it.
+	bool isExternal = obj->is_external_object;
+	int handle = obj->external_object_handle;
+	//WARNING: this line can call ObjectDeleter recursively, if obj contains the final shared pointer to another ExternalObject.
+	delete obj;
+	//Because of the recursion, shell out to the server's task thread.
+	if(isExternal && handle_destroyed_callback) server->enqueueTask([handle] () {handle_destroyed_callback(handle);});
+}
+
 std::function<void(ExternalObject*)> ObjectDeleter(std::shared_ptr<Server> server) {
 	return [=](ExternalObject* obj) mutable {
-		//We have to make sure to call the callback outside the lock.
-		//To that end, we gather information as follows, and then queue it.
-		bool isExternal;
-		int handle;
-		LOCK(*server);
-		isExternal = obj->is_external_object;
-		handle = obj->external_object_handle;
-		//WARNING: this line can call this deleter recursively, if obj contains the final shared pointer to another ExternalObject.
-		delete obj;
-		//Because of the recursion, shell out to the server's task thread.
-		if(isExternal && handle_destroyed_callback) server->enqueueTask([handle] () {handle_destroyed_callback(handle);});
+		//Destructors take locks and free memory, so the audio thread hands them to the background thread.
+		//This also keeps anything the running plan points at alive until the block is over.
+		if(isRenderingThread()) server->buryObject(obj);
+		else {
+			LOCK(*server);
+			destroyExternalObject(server.get(), obj);
+		}
 		//The server holds weak_ptrs to nodes.
 		//weak_ptrs hold references to this deleter.
 		//Therefore there is a cycle.
@@ -166,15 +164,19 @@ Lav_PUBLIC_FUNCTION LavError Lav_handleIncRef(LavHandle handle) {
 
 Lav_PUBLIC_FUNCTION LavError Lav_handleDecRef(LavHandle handle) {
 	PUB_BEGIN
-	std::unique_lock<std::recursive_mutex> l(*memory_lock);
 	if(memory_initialized == false) return Lav_ERROR_NONE;
 	auto e = incomingObject<ExternalObject>(handle);
 	auto rc = e->refcount.fetch_add(-1);
 	rc-=1;
+	//Only letting go of the last reference needs the lock.
 	if(rc == 0) {
-		external_handles->erase(e->external_object_handle);
-		//We need to be readded to the dict if we're passed out again.
-		e->has_external_mapping = false;
+		std::lock_guard<std::recursive_mutex> guard(*memory_lock);
+		//Shutdown or outgoingObject may have gotten there first.
+		if(memory_initialized && e->has_external_mapping && e->refcount.load() == 0) {
+			//We need to be readded to the table if we're passed out again.
+			e->has_external_mapping = false;
+			handle_table->dropStrongReference(e->external_object_handle);
+		}
 	}
 	PUB_END
 }
@@ -20,7 +20,9 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/buffer.hpp>
 #include <libaudioverse/private/dependency_computation.hpp>
 #include <algorithm>
+#include <math.h>
 #include <memory>
+#include <initializer_list>
 #include <stdlib.h>
 #include <string.h>
 #include <set>
@@ -28,8 +30,11 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 namespace libaudioverse_implementation {
 
+//-120 dB. Tails below this are considered over; see Node::setTail.
+const float sleep_threshold = 1e-6f;
 
-/**Given two nodes, determine if connecting an output of start to an input of end causes a cycle.*/
+/**Given two nodes, determine if connecting an output of start to an input of end causes a cycle.
+This looks at connections as staged, so needs the server's topology mutex.*/
 bool doesEdgePreserveAcyclicity(std::shared_ptr<Job> start, std::shared_ptr<Job> end) {
 	//A cycle exists if end is directly or indirectly conneccted to an input of start.
 	//To that end, we use recursion as follows.
@@ -41,13 +46,15 @@ bool doesEdgePreserveAcyclicity(std::shared_ptr<Job> start, std::shared_ptr<Job>
 	//We check by walking all dependencies of start looking for end.
 	bool cycled = false;
 	auto helper = [&](std::shared_ptr<Job> current, auto callable) {
+		//Once we've found it, don't let other branches overwrite the answer.
+		if(cycled) return;
 		cycled = current == end;
 		if(cycled) return;
 		//We're passing ourself to ourself to avoid std::functions all the way down.
-		else visitDependencies(current, callable, callable);
+		else visitDependencies<true>(current, callable, callable);
 	};
 	//And then we pass it to itself.
-	visitDependencies(start, helper, helper);
+	visitDependencies<true>(start, helper, helper);
 	return cycled == false;
 }
 
@@ -63,12 +70,13 @@ bool PropertyBackrefComparer::operator() (const std::tuple<std::weak_ptr<Node>,
 Node::Node(int type, std::shared_ptr<Server> server, unsigned int numInputBuffers, unsigned int numOutputBuffers): Job(type) {
 	this->server= server;
 	//request properties from the metadata module.
-	properties = makePropertyTable(type);
+	property_layout = getPropertyLayout(type);
+	properties = makePropertyArray(type);
 	//Associate properties to this node:
-	for(auto i: properties) {
-		auto &prop = properties[i.first];
+	for(auto &prop: properties) {
 		prop.associateNode(this);
 		prop.associateServer(server);
+		resolved_properties.push_back(&prop);
 	}
 
 	//allocations can be done simply by redirecting through resize after our initialization step.
@@ -82,73 +90,97 @@ Node::Node(int type, std::shared_ptr<Server> server, unsigned int numInputBuffer
 }
 
 Node::~Node() {
+	//Anything forwarded to us has to go back to its own property.
+	//Our weak pointers are already dead, so resolving won't find us.
+	for(auto &i: forwarded_property_backrefs) {
+		for(auto &t: i.second) {
+			auto n = std::get<0>(t).lock();
+			if(n) n->resolvePropertyForwarding(std::get<1>(t));
+		}
+	}
 	for(auto i: output_buffers) {
 		if(i) freeArray(i);
 	}
-	for(auto i: input_buffers) {
-		if(i) freeArray(i);
+	if(has_pooled_inputs == false) {
+		for(auto i: input_buffers) {
+			if(i) freeArray(i);
+		}
 	}
-	server->invalidatePlan();
+	server->invalidateDependencies(this);
 }
 
 void Node::tickProperties() {
 	for(auto &i: properties) {
-		i.second.tick();
+		i.tick();
 	}
 }
 
 void Node::tick() {
 	last_processed = server->getTickCount();
+	is_silent = false;
 	bool paused = getState() == Lav_NODESTATE_PAUSED;
 	if(paused) return;
+	bool inputsSilent = areInputsSilent();
+	//Asleep, we're as good as paused until something makes a sound at us.
+	//Outputs still have to be zeroed, since a fused dependent may have swapped buffers with us.
+	if(is_asleep) {
+		if(inputsSilent) {
+			zeroOutputBuffers();
+			is_silent = true;
+			return;
+		}
+		is_asleep = false;
+		quiet_samples = 0;
+	}
+	if(has_pooled_inputs) std::copy(pooled_buffers, pooled_buffers+input_buffers.size(), input_buffers.begin());
 	//If we're paused, then OutputConnectiona dds zeros.
 	//Consequently, we don't do this in that case.
 	if(should_zero_output_buffers) 	zeroOutputBuffers();
 	tickProperties();
-	zeroInputBuffers();
-	//Collect parent outputs onto ours.
-	//by using the getInputConnection and getInputConnectionCount functions, we allow subgraphs to override effectively.
-	bool needsMixing = getProperty(Lav_NODE_CHANNEL_INTERPRETATION).getIntValue()==Lav_CHANNEL_INTERPRETATION_SPEAKERS;
-	for(int i = 0; i < getInputConnectionCount(); i++) {
-		getInputConnection(i)->add(needsMixing);
+	auto &addProp = getProperty(Lav_NODE_ADD);
+	bool adds = addProp.needsARate() || addProp.getFloatValue() != 0.0;
+	//Silence in is silence out, so there's nothing to mix or process.  Mul doesn't matter.
+	if(is_stateless && adds == false && inputsSilent) {
+		if(should_zero_output_buffers == false) zeroOutputBuffers();
+		is_silent = true;
+		return;
+	}
+	if(takeFusedInput() == false) {
+		zeroInputBuffers();
+		//Collect parent outputs onto ours.
+		bool needsMixing = getProperty(Lav_NODE_CHANNEL_INTERPRETATION).getIntValue()==Lav_CHANNEL_INTERPRETATION_SPEAKERS;
+		float** inputs = getInputBufferArray();
+		for(auto &m: input_mix_list) {
+			m.first->add(m.second->getCount(), inputs+m.second->getStart(), needsMixing);
+		}
 	}
 	is_processing = true;
 	num_input_buffers = input_buffers.size();
 	num_output_buffers = output_buffers.size();
 	process();
-	applyMul();
-	applyAdd();
+	//Before mul, which could hide a tail that's still there.
+	bool quiet = tail_samples >= 0 && inputsSilent && adds == false && isTailQuiet();
+	applyMulAdd();
+	if(adds) is_silent = false;
 	is_processing = false;
+	if(tail_samples >= 0) updateSleep(quiet);
 }
 
-void Node::applyMul() {
+void Node::applyMulAdd() {
 	auto &mulProp = getProperty(Lav_NODE_MUL);
-	float** outputs =getOutputBufferArray();
-	if(mulProp.needsARate()) {
-		for(int i = 0; i < block_size; i++) {
-			float mul = mulProp.getFloatValue(i);
-			for(int j = 0; j < getOutputBufferCount(); j++) outputs[j][i]*=mul;
-		}
-	}
-	else if(mulProp.getFloatValue() !=1.0) {
-		for(int i = 0; i < getOutputBufferCount(); i++) {
-			scalarMultiplicationKernel(block_size, mulProp.getFloatValue(), outputs[i], outputs[i]);
-		}
-	}
-}
-
-void Node::applyAdd() {
 	auto &addProp = getProperty(Lav_NODE_ADD);
-	float** outputs = getOutputBufferArray();
-	if(addProp.needsARate()) {
-		for(int i = 0; i < block_size; i++) {
-		float add=addProp.getFloatValue(i);
-			for(int j = 0; j < getOutputBufferCount(); j++) outputs[j][i]+=add;
-		}
-	}
-	else if(addProp.getFloatValue() !=0.0) {
-		for(int i = 0; i < getOutputBufferCount(); i++) {
-			scalarAdditionKernel(block_size, addProp.getFloatValue(), outputs[i], outputs[i]);
+	float** outputs =getOutputBufferArray();
+	int outputCount = getOutputBufferCount();
+	float* mul = mulProp.getFloatValueBuffer();
+	float* add = addProp.getFloatValueBuffer();
+	float mulValue = mulProp.getFloatValue(), addValue = addProp.getFloatValue();
+	for(int i = 0; i < outputCount; i++) {
+		if(mul && add) arrayMultiplicationAdditionKernel(block_size, outputs[i], mul, add, outputs[i]);
+		else if(mul) multiplicationScalarAdditionKernel(block_size, outputs[i], mul, addValue, outputs[i]);
+		else if(add) multiplicationAdditionKernel(block_size, mulValue, outputs[i], add, outputs[i]);
+		else {
+			if(mulValue != 1.0f) scalarMultiplicationKernel(block_size, mulValue, outputs[i], outputs[i]);
+			if(addValue != 0.0f) scalarAdditionKernel(block_size, addValue, outputs[i], outputs[i]);
 		}
 	}
 }
@@ -170,6 +202,77 @@ void Node::zeroOutputBuffers() {
 	}
 }
 
+bool Node::isSilent() {
+	return is_silent;
+}
+
+bool Node::areInputsSilent() {
+	for(auto &m: input_mix_list) {
+		if(m.first->isSilent() == false) return false;
+	}
+	return true;
+}
+
+void Node::markSilent() {
+	is_silent = true;
+}
+
+void Node::setTail(double seconds, bool decays) {
+	tail_samples = seconds < 0.0 ? -1 : (int)(seconds*server->getSr());
+	tail_decays = decays;
+	quiet_samples = 0;
+}
+
+bool Node::isAsleep() {
+	return is_asleep;
+}
+
+void Node::wake() {
+	if(is_asleep == false) return;
+	//If we were culled, we need to get back into the plan.
+	bool wasCulled = canCull();
+	is_asleep = false;
+	quiet_samples = 0;
+	if(wasCulled) server->invalidateDependenciesFromJob(this);
+}
+
+void Node::updateSleep(bool quiet) {
+	if(quiet == false) {
+		quiet_samples = 0;
+		return;
+	}
+	quiet_samples += block_size;
+	if(quiet_samples <= tail_samples) return;
+	//Asleep, properties don't tick, so automation would stall.
+	for(auto &p: properties) {
+		if(p.isAutomated()) return;
+	}
+	//What's left is either zero or below the threshold.
+	zeroOutputBuffers();
+	is_silent = true;
+	is_asleep = true;
+	//With nothing connected, only a new connection can wake us, and that replans us anyway.
+	if(hasInputConnections() == false) server->invalidateDependenciesFromJob(this);
+}
+
+bool Node::isTailQuiet() {
+	if(tail_decays == false) return true;
+	float** outputs = getOutputBufferArray();
+	for(int i = 0; i < getOutputBufferCount(); i++) {
+		for(int j = 0; j < block_size; j++) {
+			if(fabs(outputs[i][j]) >= sleep_threshold) return false;
+		}
+	}
+	return true;
+}
+
+bool Node::hasInputConnections() {
+	for(int i = 0; i < getInputConnectionCount(); i++) {
+		if(getInputConnection(i)->getConnectedNodeCount()) return true;
+	}
+	return false;
+}
+
 void Node::zeroInputBuffers() {
 	int inputBufferCount=getInputBufferCount();
 	float** inputBuffers=getInputBufferArray();
@@ -181,6 +284,9 @@ void Node::zeroInputBuffers() {
 void Node::willTick() {
 }
 
+void Node::threadsChanged(int threads) {
+}
+
 int Node::getState() {
 	return getProperty(Lav_NODE_STATE).getIntValue();
 }
@@ -191,7 +297,7 @@ void Node::setState(int newState) {
 
 void Node::stateChanged() {
 	if(getState() == prev_state) return;
-	server->invalidatePlan();
+	server->invalidateDependencies(this);
 	if(prev_state == Lav_NODESTATE_ALWAYS_PLAYING) server->unregisterNodeForAlwaysPlaying(std::static_pointer_cast<Node>(shared_from_this()));
 	prev_state = getProperty(Lav_NODE_STATE).getIntValue();
 	if(prev_state == Lav_NODESTATE_ALWAYS_PLAYING) server->registerNodeForAlwaysPlaying(std::static_pointer_cast<Node>(shared_from_this()));
@@ -243,41 +349,60 @@ void Node::appendOutputConnection(int start, int count) {
 }
 
 void Node::connect(int output, std::shared_ptr<Node> toNode, int input) {
+	LOCK(server->getTopologyMutex());
 	if(doesEdgePreserveAcyclicity(std::static_pointer_cast<Node>(this->shared_from_this()), toNode) == false) ERROR(Lav_ERROR_CAUSES_CYCLE, "Connection would cause infinite loop.");
 	auto outputConnection =getOutputConnection(output);
 	auto inputConnection = toNode->getInputConnection(input);
-	makeConnection(outputConnection, inputConnection);
-	server->invalidatePlan();
+	std::unique_ptr<TopologyCommit> commit(new TopologyCommit());
+	makeConnection(outputConnection, inputConnection, *commit);
+	commit->changed_dependencies.push_back(toNode);
+	server->commitTopology(commit.release());
 }
 
 void Node::connectServer(int which) {
+	LOCK(server->getTopologyMutex());
 	auto outputConnection=getOutputConnection(which);
 	auto inputConnection = server->getFinalOutputConnection();
-	makeConnection(outputConnection, inputConnection);
-	server->invalidatePlan();
+	std::unique_ptr<TopologyCommit> commit(new TopologyCommit());
+	makeConnection(outputConnection, inputConnection, *commit);
+	commit->server_changed = true;
+	server->commitTopology(commit.release());
 }
 
 void Node::connectProperty(int output, std::shared_ptr<Node> node, int slot) {
-	if(doesEdgePreserveAcyclicity(std::static_pointer_cast<Node>(this->shared_from_this()), node) == false) ERROR(Lav_ERROR_CAUSES_CYCLE, "Connection would cause infinite loop.");
 	auto &prop = node->getProperty(slot);
 	auto conn = prop.getInputConnection();
 	if(conn ==nullptr) ERROR(Lav_ERROR_CANNOT_CONNECT_TO_PROPERTY, "Property does not support connections.");
+	//The audio thread uses these, so unlike the connection they need the lock.
+	{
+		LOCK(*server);
+		prop.allocateBuffers();
+	}
+	LOCK(server->getTopologyMutex());
+	if(doesEdgePreserveAcyclicity(std::static_pointer_cast<Node>(this->shared_from_this()), node) == false) ERROR(Lav_ERROR_CAUSES_CYCLE, "Connection would cause infinite loop.");
 	auto outputConn =getOutputConnection(output);
-	makeConnection(outputConn, conn);
-	server->invalidatePlan();
+	std::unique_ptr<TopologyCommit> commit(new TopologyCommit());
+	makeConnection(outputConn, conn, *commit);
+	//With forwarding, the property may belong to a different node.
+	commit->changed_dependencies.push_back(std::static_pointer_cast<Node>(prop.getAssociatedNode()->shared_from_this()));
+	server->commitTopology(commit.release());
 }
 
 void Node::disconnect(int output, std::shared_ptr<Node> node, int input) {
+	LOCK(server->getTopologyMutex());
 	auto o =getOutputConnection(output);
-	if(node == nullptr) o->clear();
+	std::unique_ptr<TopologyCommit> commit(new TopologyCommit());
+	if(node == nullptr) o->clear(*commit);
 	else {
 		auto other = node->getInputConnection(input);
-		breakConnection(o, other);
+		breakConnection(o, other, *commit);
 	}
-	server->invalidatePlan();
+	commit->changed_dependents.push_back(std::static_pointer_cast<Job>(shared_from_this()));
+	server->commitTopology(commit.release());
 }
 
 void Node::isolate() {
+	LOCK(server->getTopologyMutex());
 	int oc = getOutputConnectionCount();
 	for(int i = 0; i < oc; i++) disconnect(i);
 }
@@ -287,20 +412,30 @@ std::shared_ptr<Server> Node::getServer() {
 }
 
 Property& Node::getProperty(int slot, bool allowForwarding) {
-	//first the forwarded case.
-	if(allowForwarding && forwarded_properties.count(slot) !=0) {
-		auto n=std::get<0>(forwarded_properties[slot]).lock();
-		auto s=std::get<1>(forwarded_properties[slot]);
-		if(n) return n->getProperty(s);
-	}
-	if(properties.count(slot) == 0) ERROR(Lav_ERROR_RANGE, "Invalid property index or identifier.");
-	else return properties[slot];
+	int index = property_layout->getIndex(slot);
+	if(index == -1) ERROR(Lav_ERROR_RANGE, "Invalid property index or identifier.");
+	return allowForwarding ? *resolved_properties[index] : properties[index];
+}
+
+const PropertySlotInfo* Node::getPropertySlotInfo(int slot) {
+	int index = property_layout->getIndex(slot);
+	if(index == -1 || index >= (int)property_slot_info.size()) return nullptr;
+	return &property_slot_info[index];
+}
+
+void Node::makePropertySlotInfo() {
+	property_slot_info.clear();
+	for(auto &prop: properties) property_slot_info.emplace_back(prop);
 }
 
 void Node::forwardProperty(int ourProperty, std::shared_ptr<Node> toNode, int toProperty) {
+	//Check both ends before we record anything.
+	getProperty(ourProperty, false);
+	toNode->getProperty(toProperty);
 	forwarded_properties[ourProperty] = std::make_tuple(toNode, toProperty);
 	toNode->addPropertyBackref(toProperty, std::static_pointer_cast<Node>(shared_from_this()), ourProperty);
-	server->invalidatePlan();
+	resolvePropertyForwarding(ourProperty);
+	server->invalidateDependencies(this);
 }
 
 void Node::stopForwardingProperty(int ourProperty) {
@@ -313,7 +448,8 @@ void Node::stopForwardingProperty(int ourProperty) {
 		}
 	}
 	else ERROR(Lav_ERROR_INTERNAL, "Backref does not exist.");
-	server->invalidatePlan();
+	resolvePropertyForwarding(ourProperty);
+	server->invalidateDependencies(this);
 }
 
 void Node::addPropertyBackref(int ourProperty, std::shared_ptr<Node> toNode, int toProperty) {
@@ -328,7 +464,9 @@ void Node::removePropertyBackref(int ourProperty, std::shared_ptr<Node> toNode,
 }
 
 void Node::visitPropertyBackrefs(int which, std::function<void(Property&)> pred) {
-	for(auto &t: forwarded_property_backrefs[which]) {
+	auto backrefs = forwarded_property_backrefs.find(which);
+	if(backrefs == forwarded_property_backrefs.end()) return;
+	for(auto &t: backrefs->second) {
 		auto &n = std::get<0>(t);
 		auto n_s = n.lock();
 		if(n_s) {
@@ -339,6 +477,24 @@ void Node::visitPropertyBackrefs(int which, std::function<void(Property&)> pred)
 	}
 }
 
+void Node::resolvePropertyForwarding(int slot) {
+	int index = property_layout->getIndex(slot);
+	if(index == -1) return;
+	auto resolved = &properties[index];
+	auto f = forwarded_properties.find(slot);
+	if(f != forwarded_properties.end()) {
+		auto n = std::get<0>(f->second).lock();
+		if(n) resolved = &n->getProperty(std::get<1>(f->second));
+	}
+	resolved_properties[index] = resolved;
+	auto backrefs = forwarded_property_backrefs.find(slot);
+	if(backrefs == forwarded_property_backrefs.end()) return;
+	for(auto &t: backrefs->second) {
+		auto n = std::get<0>(t).lock();
+		if(n) n->resolvePropertyForwarding(std::get<1>(t));
+	}
+}
+
 void Node::lock() {
 	server->lock();
 }
@@ -352,6 +508,8 @@ void Node::reset() {
 
 //protected resize function.
 void Node::resize(int newInputCount, int newOutputCount) {
+	//The pool was sized for our old input count, so take our buffers back; the server pools them again at the end.
+	if(has_pooled_inputs) usePooledBuffers(false);
 	int oldInputCount = input_buffers.size();
 	for(int i = oldInputCount-1; i >= newInputCount; i--) if(input_buffers[i]) freeArray(input_buffers[i]);
 	input_buffers.resize(newInputCount, nullptr);
@@ -371,20 +529,81 @@ void Node::resize(int newInputCount, int newOutputCount) {
 			output_buffers[i] = allocArray<float>(server->getBlockSize());
 		}
 	}
+	server->updateBufferPooling(this);
 }
 
 void Node::execute() {
 	tick();
 }
 
+void Node::setFusedDependency(Job* dependency) {
+	//The server is never anyone's dependency, so everything here is a node.
+	fused_dependency = static_cast<Node*>(dependency);
+}
+
+bool Node::takeFusedInput() {
+	if(fused_dependency == nullptr || input_mix_list.size() != 1) return false;
+	auto output = input_mix_list[0].first;
+	auto input = input_mix_list[0].second;
+	auto from = fused_dependency;
+	int count = input->getCount();
+	//It has to be a straight copy of everything we take in: no mixing, no dropped channels.
+	if(output->getNode() != from || count == 0 || input->getStart() != 0 || count != input_buffers.size() || output->getCount() != count) return false;
+	if(output->getStart()+count > from->output_buffers.size()) return false;
+	//Subgraphs which redirect their buffers elsewhere can't do this.
+	if(getInputBufferArray() != &input_buffers[0] || from->getOutputBufferArray() != &from->output_buffers[0]) return false;
+	//Nothing else reads those outputs, and it overwrites them next block anyway.
+	//Pooled inputs aren't ours to give away, but then we can just read the outputs where they are.
+	for(int i = 0; i < count; i++) {
+		float* &o = from->output_buffers[output->getStart()+i];
+		if(has_pooled_inputs) input_buffers[i] = o;
+		else std::swap(input_buffers[i], o);
+	}
+	return true;
+}
+
+int Node::usePooledBuffers(bool pooling) {
+	bool pool = pooling && can_pool_inputs && input_buffers.size() != 0;
+	if(pool == has_pooled_inputs) return pool ? input_buffers.size() : 0;
+	for(auto &i: input_buffers) {
+		if(pool) {
+			freeArray(i);
+			i = nullptr;
+		}
+		else i = allocArray<float>(server->getBlockSize());
+	}
+	has_pooled_inputs = pool;
+	return pool ? input_buffers.size() : 0;
+}
+
+int Node::getPooledBufferCount() {
+	return has_pooled_inputs ? input_buffers.size() : 0;
+}
+
+void Node::dependenciesChanged() {
+	input_mix_list.clear();
+	//by using the getInputConnection and getInputConnectionCount functions, we allow subgraphs to override effectively.
+	for(int i = 0; i < getInputConnectionCount(); i++) {
+		auto c = getInputConnection(i);
+		c->visitOutputs([&] (OutputConnection* o) {
+			input_mix_list.emplace_back(o, c.get());
+		});
+	}
+}
+
 bool Node::canCull() {
-	return getState() == Lav_NODESTATE_PAUSED;
+	if(getState() == Lav_NODESTATE_PAUSED) return true;
+	return is_asleep && hasInputConnections() == false;
 }
 
 void Node::setShouldZeroOutputBuffers(bool v) {
 	should_zero_output_buffers = v;
 }
 
+void Node::setIsStateless(bool v) {
+	is_stateless = v;
+}
+
 //begin public api
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeGetServer(LavHandle handle, LavHandle* destination) {
@@ -398,7 +617,6 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeConnect(LavHandle nodeHandle, int output, L
 	PUB_BEGIN
 	auto node= incomingObject<Node>(nodeHandle);
 	auto dest = incomingObject<Node>(destHandle);
-	LOCK(*node);
 	node->connect(output, dest, input);
 	PUB_END
 }
@@ -406,7 +624,6 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeConnect(LavHandle nodeHandle, int output, L
 Lav_PUBLIC_FUNCTION LavError Lav_nodeConnectServer(LavHandle nodeHandle, int output) {
 	PUB_BEGIN
 	auto node = incomingObject<Node>(nodeHandle);
-	LOCK(*node);
 	node->connectServer(output);
 	PUB_END
 }
@@ -415,7 +632,6 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeConnectProperty(LavHandle nodeHandle, int o
 	PUB_BEGIN
 	auto n = incomingObject<Node>(nodeHandle);
 	auto o = incomingObject<Node>(otherHandle);
-	LOCK(*n);
 	n->connectProperty(output, o, slot);
 	PUB_END
 }
@@ -425,7 +641,6 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeDisconnect(LavHandle nodeHandle, int output
 	auto node = incomingObject<Node>(nodeHandle);
 	//We have to allow null for this one.
 	auto other = incomingObject<Node>(otherHandle, true);
-	LOCK(*node);
 	node->disconnect(output, other, input);
 	PUB_END
 }
@@ -433,7 +648,6 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeDisconnect(LavHandle nodeHandle, int output
 Lav_PUBLIC_FUNCTION LavError Lav_nodeIsolate(LavHandle nodeHandle) {
 	PUB_BEGIN
 	auto n = incomingObject<Node>(nodeHandle);
-	LOCK(*n);
 	n->isolate();
 	PUB_END
 }
@@ -462,12 +676,21 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeReset(LavHandle nodeHandle) {
 	PUB_END
 }
 
+Lav_PUBLIC_FUNCTION LavError Lav_nodeGetProcessingCost(LavHandle nodeHandle, double* destination) {
+	PUB_BEGIN
+	auto node = incomingObject<Node>(nodeHandle);
+	LOCK(*node);
+	*destination = node->getAverageCost();
+	PUB_END
+}
+
 //this is properties.
 //this is here because properties do not "know" about objects and only objects have properties; also, it made properties.cpp have to "know" about servers and objects.
 
 //this works for getters and setters to lock the object and set a variable prop to be a pointer-like thing to a property.
 #define PROP_PREAMBLE(n, s, t) auto node_ptr = incomingObject<Node>(n);\
 LOCK(*node_ptr);\
+node_ptr->getServer()->applyPropertyCommands();\
 auto &prop = node_ptr->getProperty((s));\
 if(prop.getType() != (t)) {\
 auto _t = prop.getType();\
@@ -485,12 +708,34 @@ msg += " property.";\
 ERROR(Lav_ERROR_TYPE_MISMATCH, msg);\
 }
 
+//If the server queues property writes, queue this one without the lock and return true.
+//Anything we can't check without the lock returns false, and the caller's locked path reports the error as usual.
+bool queuePropertySet(LavHandle nodeHandle, int slot, int type, std::initializer_list<double> values) {
+	auto node = incomingObject<Node>(nodeHandle);
+	auto server = node->getServer();
+	if(server->getQueuePropertyWrites() == false) return false;
+	//The live property can change under us, so check the snapshot instead.
+	//If the slot is forwarded, applying the command checks again against wherever it goes.
+	auto info = node->getPropertySlotInfo(slot);
+	if(info == nullptr || info->type != type || info->read_only || info->has_dynamic_range) return false;
+	if(info->isInRange(*values.begin()) == false) return false;
+	PropertyCommand command;
+	command.kind = PropertyCommandKinds::SET;
+	command.node = node;
+	command.slot = slot;
+	command.type = type;
+	std::copy(values.begin(), values.end(), command.values);
+	command.tick = server->getTickCount();
+	return server->enqueuePropertyCommand(command);
+}
+
 #define READONLY_CHECK if(prop.isReadOnly()) ERROR(Lav_ERROR_PROPERTY_IS_READ_ONLY, "Attempt to write a read-only property.");
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeResetProperty(LavHandle nodeHandle, int slot) {
 	PUB_BEGIN
 	auto node_ptr = incomingObject<Node>(nodeHandle);
 	LOCK(*node_ptr);
+	node_ptr->getServer()->applyPropertyCommands();
 	auto prop = node_ptr->getProperty(slot);
 	READONLY_CHECK
 	prop.reset();
@@ -499,6 +744,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeResetProperty(LavHandle nodeHandle, int slo
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeSetIntProperty(LavHandle nodeHandle, int slot, int value) {
 	PUB_BEGIN
+	if(queuePropertySet(nodeHandle, slot, Lav_PROPERTYTYPE_INT, {(double)value})) return Lav_ERROR_NONE;
 	PROP_PREAMBLE(nodeHandle, slot, Lav_PROPERTYTYPE_INT);
 	READONLY_CHECK
 	prop.setIntValue(value);
@@ -507,6 +753,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeSetIntProperty(LavHandle nodeHandle, int sl
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeSetFloatProperty(LavHandle nodeHandle, int slot, float value) {
 	PUB_BEGIN
+	if(queuePropertySet(nodeHandle, slot, Lav_PROPERTYTYPE_FLOAT, {value})) return Lav_ERROR_NONE;
 	PROP_PREAMBLE(nodeHandle, slot, Lav_PROPERTYTYPE_FLOAT);
 	READONLY_CHECK
 	prop.setFloatValue(value);
@@ -515,6 +762,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeSetFloatProperty(LavHandle nodeHandle, int
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeSetDoubleProperty(LavHandle nodeHandle, int slot, double value) {
 	PUB_BEGIN
+	if(queuePropertySet(nodeHandle, slot, Lav_PROPERTYTYPE_DOUBLE, {value})) return Lav_ERROR_NONE;
 	PROP_PREAMBLE(nodeHandle, slot, Lav_PROPERTYTYPE_DOUBLE);
 	READONLY_CHECK
 	prop.setDoubleValue(value);
@@ -531,6 +779,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeSetStringProperty(LavHandle nodeHandle, int
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeSetFloat3Property(LavHandle nodeHandle, int slot, float v1, float v2, float v3) {
 	PUB_BEGIN
+	if(queuePropertySet(nodeHandle, slot, Lav_PROPERTYTYPE_FLOAT3, {v1, v2, v3})) return Lav_ERROR_NONE;
 	PROP_PREAMBLE(nodeHandle, slot, Lav_PROPERTYTYPE_FLOAT3);
 	READONLY_CHECK
 	prop.setFloat3Value(v1, v2, v3);
@@ -539,6 +788,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_nodeSetFloat3Property(LavHandle nodeHandle, int
 
 Lav_PUBLIC_FUNCTION LavError Lav_nodeSetFloat6Property(LavHandle nodeHandle, int slot, float v1, float v2, float v3, float v4, float v5, float v6) {
 	PUB_BEGIN
+	if(queuePropertySet(nodeHandle, slot, Lav_PROPERTYTYPE_FLOAT6, {v1, v2, v3, v4, v5, v6})) return Lav_ERROR_NONE;
 	PROP_PREAMBLE(nodeHandle, slot, Lav_PROPERTYTYPE_FLOAT6);
 	READONLY_CHECK
 	prop.setFloat6Value(v1, v2, v3, v4, v5, v6);
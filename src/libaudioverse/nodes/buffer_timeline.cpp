@@ -21,6 +21,9 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/implementations/buffer_player.hpp>
 #include <iterator>
 #include <vector>
+#include <algorithm>
+#include <utility>
+#include <math.h>
 
 namespace libaudioverse_implementation {
 
@@ -37,36 +40,74 @@ std::shared_ptr<Node> createBufferTimelineNode(std::shared_ptr<Server> server, i
 
 BufferTimelineNode::~BufferTimelineNode() {
 	for(auto &i: workspace) freeArray(i);
-	for(auto &i: scheduled_buffers) delete i.second;
+	scheduled_buffers.clear([] (std::pair<double, BufferPlayer*> &s) {delete s.second;});
+	for(auto p: playing) delete p;
+	for(auto p: free_players) delete p;
 }
 
 void BufferTimelineNode::process() {
-	filter(scheduled_buffers, [&](auto &val)->bool {
-		if(val.first > time) return true;
-		if(val.second->getEndedCount()) {
-			delete val.second;
-			return false;
-		}
-		//Otherwise, add and keep.
-		val.second->process(output_channels, &workspace[0]);
-		for(int i = 0; i < output_channels; i++) additionKernel(block_size, workspace[i], output_buffers[i], output_buffers[i]);
-		return true;
+	//Start everything whose time has come.
+	scheduled_buffers.advance(ticks, [&] (std::pair<double, BufferPlayer*> &s) {
+		due_buffers.push_back(s);
 	});
+	for(auto &s: due_buffers) {
+		if(s.first <= time) playing.push_back(s.second);
+		//Rounding put it a block early.
+		else scheduled_buffers.schedule(ticks+1, s);
+	}
+	due_buffers.clear();
+	unsigned int i = 0;
+	while(i < playing.size()) {
+		auto p = playing[i];
+		if(p->getEndedCount()) {
+			releasePlayer(p);
+			playing[i] = playing.back();
+			playing.pop_back();
+			continue;
+		}
+		p->process(output_channels, &workspace[0]);
+		for(int j = 0; j < output_channels; j++) additionKernel(block_size, workspace[j], output_buffers[j], output_buffers[j]);
+		i++;
+	}
 	time+=block_size/server->getSr();
+	ticks++;
 }
 
 void BufferTimelineNode::scheduleBuffer(double time, float delta, std::shared_ptr<Buffer> buffer) {
+	//The block in which we start, give or take rounding, which process catches.
+	double blocks = ceil(time*server->getSr()/block_size-1e-6);
+	blocks = std::min(std::max(blocks, 0.0), 1e15);
 	time+=this->time; //time is relative to the node's internal time.
 	//The buffer player handles the buffer's use count.
-	auto player = new BufferPlayer(server->getBlockSize(), server->getSr());
+	auto player = acquirePlayer();
 	player->setBuffer(buffer);
 	player->setRate(delta);
-	scheduled_buffers.insert(decltype(scheduled_buffers)::value_type(time, player));
+	scheduled_buffers.schedule(ticks+(uint64_t)blocks, std::make_pair(time, player));
 }
 
 void BufferTimelineNode::reset() {
-	for(auto &i: scheduled_buffers) delete i.second;
-	scheduled_buffers.clear();
+	scheduled_buffers.clear([&] (std::pair<double, BufferPlayer*> &s) {releasePlayer(s.second);});
+	for(auto p: playing) releasePlayer(p);
+	playing.clear();
+}
+
+BufferPlayer* BufferTimelineNode::acquirePlayer() {
+	if(free_players.empty() == false) {
+		auto p = free_players.back();
+		free_players.pop_back();
+		return p;
+	}
+	player_count++;
+	due_buffers.reserve(player_count);
+	playing.reserve(player_count);
+	free_players.reserve(player_count);
+	return new BufferPlayer(server->getBlockSize(), server->getSr());
+}
+
+void BufferTimelineNode::releasePlayer(BufferPlayer* player) {
+	//Let go of the buffer now rather than whenever the player is reused.
+	player->setBuffer(nullptr);
+	free_players.push_back(player);
 }
 
 //begin public API.
@@ -30,6 +30,7 @@ ConvolverNode::ConvolverNode(std::shared_ptr<Server> server, int channels): Node
 	convolvers=new BlockConvolver*[channels]();
 	for(int i= 0; i < channels; i++) convolvers[i] = new BlockConvolver(server->getBlockSize());
 	setShouldZeroOutputBuffers(false);
+	setTail(0.0);
 }
 
 std::shared_ptr<Node> createConvolverNode(std::shared_ptr<Server> server, int channels) {
@@ -50,6 +51,7 @@ void ConvolverNode::setImpulseResponse() {
 	auto ir=getProperty(Lav_CONVOLVER_IMPULSE_RESPONSE).getFloatArrayPtr();
 	int len =getProperty(Lav_CONVOLVER_IMPULSE_RESPONSE).getFloatArrayLength();
 	for(int i = 0; i < channels; i++) convolvers[i]->setResponse(len, ir);
+	setTail(len/server->getSr());
 }
 
 //begin public api
@@ -27,6 +27,8 @@ CrossfadingDelayNode::CrossfadingDelayNode(std::shared_ptr<Server> server, float
 	getProperty(Lav_DELAY_DELAY_MAX).setFloatValue(maxDelay);
 	appendInputConnection(0, channels);
 	appendOutputConnection(0, channels);
+	//Feedback means the echoes never quite stop.
+	setTail(maxDelay, true);
 }
 
 std::shared_ptr<Node> createCrossfadingDelayNode(std::shared_ptr<Server> server, float maxDelay, unsigned int channels) {
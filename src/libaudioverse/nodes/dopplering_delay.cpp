@@ -27,6 +27,7 @@ DoppleringDelayNode::DoppleringDelayNode(std::shared_ptr<Server> server, float m
 	getProperty(Lav_DELAY_DELAY_MAX).setFloatValue(maxDelay);
 	appendInputConnection(0, channels);
 	appendOutputConnection(0, channels);
+	setTail(maxDelay);
 }
 
 std::shared_ptr<Node> createDoppleringDelayNode(std::shared_ptr<Server> server, float maxDelay, int channels) {
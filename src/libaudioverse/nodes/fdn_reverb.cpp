@@ -64,6 +64,8 @@ FdnReverbNode::FdnReverbNode(std::shared_ptr<Server> s): Node(Lav_OBJTYPE_FDN_RE
 	appendOutputConnection(0, 4);
 	getProperty(Lav_FDN_REVERB_CUTOFF_FREQUENCY).setFloatRange(0.0f, sr/2.0);
 	setShouldZeroOutputBuffers(false);
+	//The delay lines are a second long.
+	setTail(1.0, true);
 }
 
 std::shared_ptr<Node> createFdnReverbNode(std::shared_ptr<Server> server) {
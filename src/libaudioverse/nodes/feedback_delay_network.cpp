@@ -70,6 +70,7 @@ Node(Lav_OBJTYPE_FEEDBACK_DELAY_NETWORK_NODE, server, channels, channels) {
 	getProperty(Lav_FDN_FILTER_FREQUENCIES).zeroArray(channels);
 	
 	setShouldZeroOutputBuffers(false);
+	setTail(maxDelay, true);
 }
 
 FeedbackDelayNetworkNode::~FeedbackDelayNetworkNode() {
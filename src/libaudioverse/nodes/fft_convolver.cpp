@@ -18,8 +18,12 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/constants.hpp>
 #include <libaudioverse/private/file.hpp>
 #include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/error.hpp>
+#include <libaudioverse/private/logging.hpp>
 #include <libaudioverse/implementations/convolvers.hpp>
 #include <string>
+#include <algorithm>
+#include <limits>
 
 namespace libaudioverse_implementation {
 
@@ -28,8 +32,15 @@ FftConvolverNode::FftConvolverNode(std::shared_ptr<Server> server, int channels)
 	appendInputConnection(0, channels);
 	this->channels=channels;
 	appendOutputConnection(0, channels);
-	convolvers=new FftConvolver*[channels]();
-	for(int i= 0; i < channels; i++) convolvers[i] = new FftConvolver(server->getBlockSize());
+	convolvers=new NonuniformConvolver*[channels]();
+	for(int i= 0; i < channels; i++) convolvers[i] = new NonuniformConvolver(server->getBlockSize());
+	incoming = new NonuniformConvolver*[channels]();
+	outgoing = new NonuniformConvolver*[channels]();
+	crossfade_positions = new int[channels]();
+	crossfade_lengths = new int[channels]();
+	response_generations = new int[channels]();
+	crossfade_workspace = allocArray<float>(server->getBlockSize());
+	setTail(0.0);
 }
 
 std::shared_ptr<Node> createFftConvolverNode(std::shared_ptr<Server> server, int channels) {
@@ -37,28 +48,85 @@ std::shared_ptr<Node> createFftConvolverNode(std::shared_ptr<Server> server, int
 }
 
 FftConvolverNode::~FftConvolverNode() {
-	for(int i = 0; i < channels; i++) delete convolvers[i];
+	for(int i = 0; i < channels; i++) {
+		delete convolvers[i];
+		delete incoming[i];
+		delete outgoing[i];
+	}
 	delete[] convolvers;
+	delete[] incoming;
+	delete[] outgoing;
+	delete[] crossfade_positions;
+	delete[] crossfade_lengths;
+	delete[] response_generations;
+	freeArray(crossfade_workspace);
 }
 
 void FftConvolverNode::process() {
 	for(int i= 0; i < channels; i++) {
+		if(incoming[i]) swapInResponse(i);
 		convolvers[i]->convolve(input_buffers[i], output_buffers[i]);
+		if(outgoing[i]) crossfadeOutResponse(i);
+	}
+}
+
+void FftConvolverNode::swapInResponse(int channel) {
+	//Crossfades don't stack: anything still fading out stops now.
+	if(outgoing[channel]) retire(outgoing[channel]);
+	outgoing[channel] = convolvers[channel];
+	convolvers[channel] = incoming[channel];
+	incoming[channel] = nullptr;
+	crossfade_positions[channel] = 0;
+	//The property goes up to infinity, which doesn't fit in an int.
+	double crossfade = getProperty(Lav_FFT_CONVOLVER_CROSSFADE_TIME).getFloatValue()*(double)server->getSr();
+	crossfade_lengths[channel] = (int)std::min(crossfade, (double)(std::numeric_limits<int>::max()-block_size));
+	if(crossfade_lengths[channel] == 0) {
+		retire(outgoing[channel]);
+		outgoing[channel] = nullptr;
+	}
+	longest_response = std::max(longest_response, convolvers[channel]->getResponseLength());
+	setTail(longest_response/server->getSr());
+}
+
+void FftConvolverNode::crossfadeOutResponse(int channel) {
+	outgoing[channel]->convolve(input_buffers[channel], crossfade_workspace);
+	float* output = output_buffers[channel];
+	int position = crossfade_positions[channel], length = crossfade_lengths[channel];
+	for(int i = 0; i < block_size; i++) {
+		float weight = std::min(1.0f, (position+i)/(float)length);
+		output[i] = output[i]*weight+crossfade_workspace[i]*(1.0f-weight);
+	}
+	crossfade_positions[channel] += block_size;
+	if(crossfade_positions[channel] >= length) {
+		retire(outgoing[channel]);
+		outgoing[channel] = nullptr;
 	}
 }
 
+void FftConvolverNode::retire(NonuniformConvolver* convolver) {
+	//This is the audio thread, so it can neither free the convolver nor take a lock to queue a task that would.
+	server->retire(convolver);
+}
+
 void FftConvolverNode::setResponse(int channel, int length, float* response) {
 	if(channel >= channels || channel < 0) ERROR(Lav_ERROR_RANGE, "Channel out of range.");
 	if(length < 1) ERROR(Lav_ERROR_RANGE, "Response must be at least one sample.");
 	convolvers[channel]->setResponse(length, response);
 	convolvers[channel]->reset();
+	//This replaces anything still loading.
+	response_generations[channel]++;
+	delete incoming[channel];
+	incoming[channel] = nullptr;
+	//Only ever grows, but the convolvers reset so it's at worst a little late to sleep.
+	longest_response = std::max(longest_response, length);
+	setTail(longest_response/server->getSr());
 }
 
-void FftConvolverNode::setResponseFromFile(std::string path, int fileChannel, int convolverChannel) {
-	if(convolverChannel < 0 || convolverChannel >= channels) ERROR(Lav_ERROR_RANGE, "Channel out of range.");
-	if(fileChannel < 0) ERROR(Lav_ERROR_RANGE, "File channel must be positive.");
+//Everything slow about setting a response from a file: reading it, resampling it, and working out the spectra.
+NonuniformConvolver* loadResponseFromFile(std::string path, int fileChannel, int sr, int blockSize) {
 	FileReader reader{};
 	reader.open(path.c_str());
+	//Checked before the load started, but the file might have changed since.
 	if(fileChannel >= reader.getChannelCount()) ERROR(Lav_ERROR_RANGE, "Channel greater than channels in file.");
 	unsigned int bufferSize= reader.getSampleCount();
 	float* tmp=allocArray<float>(bufferSize);
@@ -69,11 +137,53 @@ void FftConvolverNode::setResponseFromFile(std::string path, int fileChannel, in
 	//Resample if needed.
 	float* resampledTmp;
 	int resampledTmpLength;
-	staticResamplerKernel(reader.getSr(), server->getSr(), 1, reader.getFrameCount(), tmp, &resampledTmpLength, &resampledTmp);
-	//Finally, set the specified convolver.
-	setResponse(convolverChannel, resampledTmpLength, resampledTmp);
+	staticResamplerKernel(reader.getSr(), sr, 1, reader.getFrameCount(), tmp, &resampledTmpLength, &resampledTmp);
+	//Finally, make the convolver.
+	auto convolver = new NonuniformConvolver(blockSize);
+	convolver->setResponse(resampledTmpLength, resampledTmp);
 	freeArray(tmp);
 	delete[] resampledTmp;
+	return convolver;
+}
+
+void FftConvolverNode::setResponseFromFile(std::string path, int fileChannel, int convolverChannel) {
+	if(convolverChannel < 0 || convolverChannel >= channels) ERROR(Lav_ERROR_RANGE, "Channel out of range.");
+	if(fileChannel < 0) ERROR(Lav_ERROR_RANGE, "File channel must be positive.");
+	//Opening only reads the header, and this is the last chance to report a bad path or channel to the caller.
+	FileReader reader{};
+	reader.open(path.c_str());
+	if(fileChannel >= reader.getChannelCount()) ERROR(Lav_ERROR_RANGE, "Channel greater than channels in file.");
+	reader.close();
+	int generation = ++response_generations[convolverChannel];
+	std::weak_ptr<FftConvolverNode> weak = std::static_pointer_cast<FftConvolverNode>(shared_from_this());
+	int sr = (int)server->getSr(), blockSize = server->getBlockSize();
+	server->enqueueTask([=] () {
+		NonuniformConvolver* convolver;
+		try {
+			convolver = loadResponseFromFile(path, fileChannel, sr, blockSize);
+		}
+		catch(ErrorException &e) {
+			//The caller is long gone, so all we can do is say so.
+			logInfo("FFT convolver: couldn't load a response from %s: %s", path.c_str(), e.message.c_str());
+			return;
+		}
+		auto node = weak.lock();
+		if(node) node->publishResponse(convolverChannel, generation, convolver);
+		else delete convolver;
+	});
+}
+
+void FftConvolverNode::publishResponse(int channel, int generation, NonuniformConvolver* convolver) {
+	NonuniformConvolver* discard = convolver;
+	{
+		LOCK(*this);
+		if(generation == response_generations[channel]) {
+			//If the last one never got swapped in, this replaces it.
+			discard = incoming[channel];
+			incoming[channel] = convolver;
+		}
+	}
+	delete discard;
 }
 
 //begin public api
@@ -38,6 +38,8 @@ void FileStreamerNode::process() {
 	streamer.process(&output_buffers[0]);
 	getProperty(Lav_FILE_STREAMER_POSITION).setDoubleValue(streamer.getPosition());
 	if(streamer.getEnded()) {
+		//The streamer only ends on a block it got nothing for.
+		markSilent();
 		getProperty(Lav_FILE_STREAMER_ENDED).setIntValue(1);
 		server->enqueueTask([=] () {(*end_callback)();});
 	}
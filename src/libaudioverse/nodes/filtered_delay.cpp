@@ -34,6 +34,7 @@ FilteredDelayNode::FilteredDelayNode(std::shared_ptr<Server> server, float maxDe
 	biquads = new BiquadFilter*[channels]();
 	for(int i= 0; i < channels; i++) biquads[i] = new BiquadFilter(server->getSr());
 	prev_type = getProperty(Lav_BIQUAD_FILTER_TYPE).getIntValue();
+	setTail(maxDelay, true);
 }
 
 std::shared_ptr<Node> createFilteredDelayNode(std::shared_ptr<Server> server, float maxDelay, unsigned int channels) {
@@ -20,6 +20,7 @@ namespace libaudioverse_implementation {
 
 GainNode::GainNode(std::shared_ptr<Server> s): Node(Lav_OBJTYPE_GAIN_NODE, s, 0, 0) {
 	setShouldZeroOutputBuffers(false);
+	setIsStateless(true);
 }
 
 std::shared_ptr<Node> createGainNode(std::shared_ptr<Server> server) {
@@ -22,6 +22,7 @@ HardLimiterNode::HardLimiterNode(std::shared_ptr<Server> server, int channels):
 	appendInputConnection(0, channels);
 	appendOutputConnection(0, channels);
 	setShouldZeroOutputBuffers(false);
+	setIsStateless(true);
 }
 
 std::shared_ptr<Node>createHardLimiterNode(std::shared_ptr<Server> server, int channels) {
@@ -23,6 +23,7 @@ RingmodNode::RingmodNode(std::shared_ptr<Server> s): Node(Lav_OBJTYPE_RINGMOD_NO
 	appendInputConnection(1, 1);
 	appendOutputConnection(0, 1);
 	setShouldZeroOutputBuffers(false);
+	setIsStateless(true);
 }
 
 std::shared_ptr<Node> createRingmodNode(std::shared_ptr<Server> server) {
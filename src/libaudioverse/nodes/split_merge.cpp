@@ -18,6 +18,9 @@ carrying such notice may not be copied, modified, or distributed except accordin
 namespace libaudioverse_implementation {
 
 SplitMergeNode::SplitMergeNode(std::shared_ptr<Server> server, int type): Node(type, server, 0, 1) {
+	//Our inputs are our outputs.
+	can_pool_inputs = false;
+	setIsStateless(true);
 }
 
 std::shared_ptr<Node> createSplitMergeNode(std::shared_ptr<Server> server, int type) {
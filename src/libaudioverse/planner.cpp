@@ -8,131 +8,458 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/planner.hpp>
 #include <libaudioverse/private/audio_thread.hpp>
 #include <libaudioverse/private/logging.hpp>
+#include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/dependency_computation.hpp>
 #include <libaudioverse/private/helper_templates.hpp>
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 namespace libaudioverse_implementation {
 
+thread_local int current_worker = 0;
+//How much each new measurement of a job's cost counts.
+const double cost_smoothing = 0.1;
+//How often to reprioritize if the graph doesn't change.
+const int prioritize_interval = 64;
+
 Planner::Planner() {
+	job_invalidations = new powercores::MpmcQueue<Job*>(256);
 }
 
 Planner::~Planner() {
+	for(auto i: buffer_pool) freeArray(i);
+	delete job_invalidations;
 }
 
 void Planner::execute(std::shared_ptr<Job> start, int threads) {
+	is_executing = true;
 	if(last_start.lock() != start) invalidatePlan();
 	if(is_valid == false) replan(start);
-	else initializeStrongPlan(); //Try to get it from the cache.
-	//We might invalidate because of a dead weak pointer, but this can only happen once.
-	if(is_valid == false) replan(start);
-	if(threads == 1) {
+	else applyChanges();
+	if(compiled_generation != generation) compile();
+	if(blocks_since_prioritizing >= prioritize_interval) prioritize();
+	blocks_since_prioritizing++;
+	//Reset the counters. This is the only per-job work we do before running.
+	for(int i = 0; i < compiled.size(); i++) remaining_dependencies[i].store(compiled[i].dependency_count, std::memory_order_relaxed);
+	//If the graph is a chain, threads can only slow us down.
+	if(threads == 1 || max_parallelism < 2) {
 		runJobsSync();
 	}
 	else {
-		if(started_thread_pool == false) {
-			thread_pool.setThreadCount(threads);
-			thread_pool.start();
-			started_thread_pool = true;
+		//The thread calling us is also a worker, so the group needs one less.
+		if(started_workers == false) {
+			workers.setThreadCount(threads-1);
+			workers.start();
+			started_workers = true;
 			last_thread_count = threads;
 		}
 		if(last_thread_count != threads) {
-			thread_pool.setThreadCount(threads);
+			workers.setThreadCount(threads-1);
 			last_thread_count = threads;
 		}
-		runJobsAsync();
+		runJobsAsync(threads);
 	}
-	clearStrongPlan();
+	//Jobs can't die until we return, so these are all still alive.
+	Job* invalidated;
+	while(job_invalidations->dequeue(invalidated)) invalidateDependencies(invalidated);
 	last_start = start;
+	is_executing = false;
 }
 
-void jobExecutor(std::shared_ptr<Job> &j) {
-	j->execute();
-	j->job_recorded = false;
+void Planner::runJobsSync() {
+	active_worker_count = 1;
+	if(deques.empty()) deques.emplace_back(new powercores::WorkStealingDeque<int>());
+	deques[0]->reserve(compiled.size());
+	//Deques pop the most recently pushed job first.
+	for(int i = roots.size()-1; i >= 0; i--) deques[0]->push(roots[i]);
+	jobs_remaining.store(compiled.size(), std::memory_order_relaxed);
+	becomeAudioThread(audio_thread_configuration);
+	workerLoop(0);
+	//We are potentially sharing this thread with someone else. It is important that we don't accidentally give them high priority too.
+	unbecomeAudioThread();
 }
 
-void Planner::runJobsSync() {
-	becomeAudioThread();
-	for(auto &bin: plan) {
-		for(auto &j: bin.second) {
-			jobExecutor(j);
-		}
+/**The async executor works as follows.
+
+Every job knows how many jobs in the plan it depends on.  At the start of the block, we copy that into an atomic counter for the job and deal the jobs with no dependencies out to the workers.
+When a job finishes, it decrements the counters of everything that depends on it.  Whoever takes a counter to zero owns that job: the one with the highest priority is run immediately on the same thread, and any others go into that thread's deque.
+Roots are dealt out most expensive first, each to whichever worker has the least work so far.
+Idle workers steal from the top of other workers' deques.
+This means that a slow job only holds up the jobs which actually need its output, rather than everything at the next depth.
+
+The calling thread is worker 0, and we never wake more workers than jobs can be ready at once, so narrow graphs stay on the calling thread.*/
+void Planner::runJobsAsync(int threads) {
+	active_worker_count = std::min(threads, max_parallelism);
+	while(deques.size() < active_worker_count) deques.emplace_back(new powercores::WorkStealingDeque<int>());
+	//Nothing can push more jobs than there are in the plan.
+	for(int i = 0; i < active_worker_count; i++) deques[i]->reserve(compiled.size());
+	//No other thread is running yet, so we can push to deques we don't own.
+	worker_loads.assign(active_worker_count, 0.0);
+	root_workers.resize(roots.size());
+	for(int i = 0; i < roots.size(); i++) {
+		int w = std::min_element(worker_loads.begin(), worker_loads.end())-worker_loads.begin();
+		root_workers[i] = w;
+		worker_loads[w] += compiled_costs[roots[i]];
 	}
-	//We are potentially sharing this thread with someone else. It is important that we don't accidentally give them high priority too.
+	//Deques pop the most recently pushed job first, so push the least important first.
+	for(int i = roots.size()-1; i >= 0; i--) deques[root_workers[i]]->push(roots[i]);
+	jobs_remaining.store(compiled.size(), std::memory_order_relaxed);
+	becomeAudioThread(audio_thread_configuration);
+	//This returns only when every worker has left workerLoop, so nobody is looking at the deques when we reset them next block.
+	workers.run(active_worker_count, [this] (int worker) {
+		workerLoop(worker);
+	});
 	unbecomeAudioThread();
 }
 
-void Planner::runJobsAsync() {
-	//becomeAudioThread is no-op if called multiple times.
-	//Putting it here greatly simplifies thread pool startup logic.
-	thread_pool.submitJobToAllThreads(becomeAudioThread);
-	for(auto &bin: plan) {
-		thread_pool.map(jobExecutor, bin.second.begin(), bin.second.end());
-		thread_pool.submitBarrier();
+void Planner::workerLoop(int worker) {
+	RenderingScope rendering;
+	current_worker = worker;
+	//The workers are ours, so this only does anything the first time or after the configuration changes.
+	if(worker != 0) becomeAudioThread(audio_thread_configuration, worker, true);
+	auto &own = *deques[worker];
+	int index;
+	while(jobs_remaining.load(std::memory_order_acquire) > 0) {
+		bool found = own.pop(index);
+		for(int i = 1; i < active_worker_count && found == false; i++) {
+			found = deques[(worker+i)%active_worker_count]->steal(index);
+		}
+		if(found == false) {
+			//Everything runnable is running somewhere else.
+			std::this_thread::yield();
+			continue;
+		}
+		while(index != -1) index = runJob(index, worker);
+	}
+	current_worker = 0;
+}
+
+int Planner::runJob(int index, int worker) {
+	auto &c = compiled[index];
+	float** pool = pool_width ? &buffer_pool[worker*pool_width] : nullptr;
+	//Chains run back to back, while their buffers are still in cache.
+	for(int i = c.jobs_begin; i < c.jobs_end; i++) {
+		auto job = compiled_jobs[i];
+		job->pooled_buffers = pool;
+		auto startTime = std::chrono::steady_clock::now();
+		job->execute();
+		double cost = std::chrono::duration<double>(std::chrono::steady_clock::now()-startTime).count();
+		job->average_cost = job->measured_cost ? job->average_cost+cost_smoothing*(cost-job->average_cost) : cost;
+		job->measured_cost = true;
 	}
-	//At this point, submit a meaningless job that does nothing.
-	//This lets us synchronize with the end of this batch.
-	auto future = thread_pool.submitJobWithResult([](){});
-	future.wait();
-	//And that's it.
+	int next = -1;
+	//Dependents are in increasing order of priority, so we keep the last one that becomes ready and push the rest.
+	//The deque then hands them back most important first.
+	for(int i = c.dependents_begin; i < c.dependents_end; i++) {
+		int d = compiled_dependents[i];
+		if(remaining_dependencies[d].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			if(next != -1) deques[worker]->push(next);
+			next = d;
+		}
+	}
+	jobs_remaining.fetch_sub(1, std::memory_order_release);
+	return next;
+}
+
+bool Planner::isExecuting() {
+	return is_executing;
+}
+
+void Planner::setAudioThreadConfiguration(const AudioThreadConfiguration &config) {
+	audio_thread_configuration = config;
+}
+
+void Planner::setBufferPooling(bool pooling, int blockSize) {
+	if(pooling == buffer_pooling) return;
+	buffer_pooling = pooling;
+	pool_block_size = blockSize;
+	//Every job in the plan has to be asked again.
+	invalidatePlan();
+}
+
+//Grows like push_back would, so that asking for one more at a time doesn't reallocate every time.
+template<typename T>
+void reserveAtLeast(std::vector<T> &v, size_t needed) {
+	if(v.capacity() < needed) v.reserve(std::max(needed, 2*v.capacity()));
+}
+
+void Planner::reserve(int jobs, int threads) {
+	reserveAtLeast(entries, jobs);
+	reserveAtLeast(free_entries, jobs);
+	reserveAtLeast(dirty_entries, jobs);
+	reserveAtLeast(compiled, jobs);
+	reserveAtLeast(compiled_jobs, jobs);
+	reserveAtLeast(compiled_tails, jobs);
+	reserveAtLeast(compiled_indices, jobs);
+	reserveAtLeast(fused_predecessors, jobs);
+	reserveAtLeast(compiled_order, jobs);
+	reserveAtLeast(roots, jobs);
+	reserveAtLeast(root_workers, jobs);
+	reserveAtLeast(priorities, jobs);
+	reserveAtLeast(compiled_costs, jobs);
+	reserveAtLeast(worker_loads, threads);
+	if(remaining_dependencies_capacity < jobs) {
+		remaining_dependencies.reset(new std::atomic<int>[jobs]);
+		remaining_dependencies_capacity = jobs;
+	}
+	while(deques.size() < threads) deques.emplace_back(new powercores::WorkStealingDeque<int>());
+	for(auto &d: deques) d->reserve(jobs);
+}
+
+void Planner::reserveBufferPool(int width, int threads) {
+	//The pool only ever grows.
+	while(buffer_pool.size() < width*threads) buffer_pool.push_back(allocArray<float>(pool_block_size));
+}
+
+double Planner::getCriticalPathCost() {
+	return critical_path_cost;
+}
+
+int Planner::getCurrentWorker() {
+	return current_worker;
 }
 
 void Planner::invalidatePlan() {
 	is_valid = false;
 }
 
-//Actually do the planning below here:
-//Small helper  function, which needn't know about the class (thus avoiding capture requirements).
-inline void binner(std::shared_ptr<Job> job, int tag, std::map<int, std::vector<std::shared_ptr<Job>>> &destination) {
-	//if the job is recorded or cullable, we can skip out.
-	if(job->job_recorded || job->canCull()) return;
-	//Visit our dependencies first.  We want this to make sure we're in the lowest bin we have to be in.
-	//Consider a graph, a->b, a->c->b.
-	//If we're called on b as a's dependency and record, then it won't happen before c.
-	visitDependencies(job, binner, tag-1, destination);
-	//The job may have just been recorded.  if it was, we can abort.
-	if(job->job_recorded) return;
-	//We know it can't be culled because this never changes. So put it in.
-	destination[tag].emplace_back(job);
-	job->job_recorded = true;
+void Planner::invalidateDependencies(Job* job) {
+	if(job->plan_index != -1) markDirty(job->plan_index);
+}
+
+void Planner::invalidateDependents(Job* job) {
+	if(job->plan_index == -1) return;
+	for(auto d: entries[job->plan_index].dependents) markDirty(d);
 }
 
+void Planner::invalidateDependenciesFromJob(Job* job) {
+	if(is_executing == false) invalidateDependencies(job);
+	else job_invalidations->enqueue(job);
+}
+
+void Planner::markDirty(int index) {
+	if(entries[index].dirty) return;
+	entries[index].dirty = true;
+	dirty_entries.push_back(index);
+}
+
+//Actually do the planning below here.
 void Planner::replan(std::shared_ptr<Job> start) {
 	logDebug("Replanning.");
-	//Fill the vector with the jobs.
-	binner(start, 0, plan);
+	//Anything still alive must forget its slot.
+	for(auto &e: entries) {
+		if(e.in_use && e.weak_job.expired() == false) e.job->plan_index = -1;
+	}
+	entries.clear();
+	free_entries.clear();
+	dirty_entries.clear();
+	edge_count = 0;
+	start_index = addJob(start);
 	is_valid = true;
-	//Put in weak_plan, the cache.
-	//We do two loops because we really don't want to keep deleting and recreating the vectors.
-	//First loop: kill bins in the weak plan that have no correspondance anymore.
-	filter(weak_plan, [](decltype(weak_plan)::value_type &i, decltype(plan) &plan)->bool {
-		return plan.count(i.first);
-	}, plan);
-	for(auto &bin: plan) {
-		weak_plan[bin.first].assign(bin.second.begin(), bin.second.end());
-	}
-}
-
-void Planner::clearStrongPlan() {
-	for(auto &bin: plan) bin.second.clear();
-}
-
-void Planner::initializeStrongPlan() {
-	for(auto &bin: weak_plan) {
-		auto &b = plan[bin.first];
-		b.resize(bin.second.size());
-		int i = 0;
-		for(auto &j: bin.second) {
-			b[i] = j.lock();
-			if(b[i] == nullptr) {
-				invalidatePlan();
-				return;
-			}
-			i++;
+	generation++;
+}
+
+void Planner::applyChanges() {
+	if(dirty_entries.empty()) return;
+	logDebug("Updating plan for %i changed jobs.", (int)dirty_entries.size());
+	generation++;
+	//Updating can dirty more entries, so this can't use iterators.
+	for(int i = 0; i < dirty_entries.size(); i++) {
+		int index = dirty_entries[i];
+		//Might have been removed or reused since it was marked.
+		if(entries[index].in_use == false || entries[index].dirty == false) continue;
+		auto job = entries[index].weak_job.lock();
+		if(job == nullptr) removeJob(index);
+		else updateJob(index, job);
+	}
+	dirty_entries.clear();
+}
+
+void dependencyCollector(std::shared_ptr<Job> job, std::vector<std::shared_ptr<Job>> &destination) {
+	destination.push_back(job);
+}
+
+int Planner::addJob(std::shared_ptr<Job> job) {
+	int index;
+	if(free_entries.empty()) {
+		index = entries.size();
+		entries.emplace_back();
+	}
+	else {
+		index = free_entries.back();
+		free_entries.pop_back();
+	}
+	entries[index].job = job.get();
+	entries[index].weak_job = job;
+	entries[index].in_use = true;
+	job->plan_index = index;
+	updateJob(index, job);
+	return index;
+}
+
+void Planner::updateJob(int index, std::shared_ptr<Job> job) {
+	//Careful: adding jobs can reallocate entries, so we can't hold references across it.
+	entries[index].dirty = false;
+	bool culled = job->canCull();
+	std::vector<int> newDependencies;
+	//Culled jobs don't run, so they don't need their dependencies.
+	if(culled == false) {
+		std::vector<std::shared_ptr<Job>> found;
+		visitDependencies(job, dependencyCollector, found);
+		for(auto &d: found) {
+			int i = d->plan_index;
+			if(i == -1) i = addJob(d);
+			newDependencies.push_back(i);
+		}
+		//If there are multiple connections between the same two jobs, we see the dependency more than once.
+		std::sort(newDependencies.begin(), newDependencies.end());
+		newDependencies.erase(std::unique(newDependencies.begin(), newDependencies.end()), newDependencies.end());
+	}
+	if(culled == false) job->dependenciesChanged();
+	if(culled != entries[index].culled) {
+		entries[index].culled = culled;
+		for(auto d: entries[index].dependents) entries[d].dependency_count += culled ? -1 : 1;
+	}
+	std::vector<int> added, removed;
+	auto &old = entries[index].dependencies;
+	std::set_difference(newDependencies.begin(), newDependencies.end(), old.begin(), old.end(), std::back_inserter(added));
+	std::set_difference(old.begin(), old.end(), newDependencies.begin(), newDependencies.end(), std::back_inserter(removed));
+	for(auto a: added) {
+		auto &d = entries[a].dependents;
+		d.insert(std::lower_bound(d.begin(), d.end(), index), index);
+	}
+	//Edges only come from here, so this is the one place compile's room for them has to grow.
+	edge_count += added.size();
+	edge_count -= removed.size();
+	reserveAtLeast(compiled_dependents, edge_count);
+	int count = 0;
+	for(auto d: newDependencies) if(entries[d].culled == false) count++;
+	entries[index].dependencies = std::move(newDependencies);
+	entries[index].dependency_count = count;
+	for(auto r: removed) {
+		auto &d = entries[r].dependents;
+		d.erase(std::lower_bound(d.begin(), d.end(), index));
+		if(d.empty() && r != start_index) removeJob(r);
+	}
+}
+
+void Planner::removeJob(int index) {
+	auto dependencies = std::move(entries[index].dependencies);
+	auto dependents = std::move(entries[index].dependents);
+	bool culled = entries[index].culled;
+	//If the job is dead, the pointer is too.
+	if(entries[index].weak_job.expired() == false) entries[index].job->plan_index = -1;
+	entries[index] = PlanEntry();
+	free_entries.push_back(index);
+	edge_count -= dependencies.size()+dependents.size();
+	//Normally nothing depends on us by now, but jobs can die while still being depended on.
+	for(auto d: dependents) {
+		auto &e = entries[d];
+		e.dependencies.erase(std::lower_bound(e.dependencies.begin(), e.dependencies.end(), index));
+		if(culled == false) e.dependency_count--;
+	}
+	for(auto d: dependencies) {
+		auto &e = entries[d].dependents;
+		e.erase(std::lower_bound(e.begin(), e.end(), index));
+		if(e.empty() && d != start_index) removeJob(d);
+	}
+}
+
+void Planner::compile() {
+	compiled.clear();
+	compiled_jobs.clear();
+	compiled_dependents.clear();
+	compiled_tails.clear();
+	roots.clear();
+	max_parallelism = 0;
+	pool_width = 0;
+	compiled_indices.assign(entries.size(), -1);
+	//A job joins the chain of its only running dependency, if it is also that dependency's only dependent.
+	fused_predecessors.assign(entries.size(), -1);
+	for(int i = 0; i < entries.size(); i++) {
+		auto &e = entries[i];
+		if(e.in_use == false || e.culled || e.dependency_count != 1) continue;
+		int p = -1;
+		for(auto d: e.dependencies) {
+			if(entries[d].culled == false) p = d;
 		}
+		if(entries[p].dependents.size() == 1) fused_predecessors[i] = p;
+	}
+	//Every running job which didn't join a chain starts one.
+	for(int i = 0; i < entries.size(); i++) {
+		if(entries[i].in_use == false || entries[i].culled || fused_predecessors[i] != -1) continue;
+		int index = compiled.size();
+		compiled.emplace_back();
+		compiled[index].jobs_begin = compiled_jobs.size();
+		compiled[index].dependency_count = entries[i].dependency_count;
+		Job* previous = nullptr;
+		int tail = i;
+		for(int j = i; j != -1; ) {
+			auto job = entries[j].job;
+			job->setFusedDependency(previous);
+			pool_width = std::max(pool_width, job->getPooledBufferCount());
+			compiled_jobs.push_back(job);
+			compiled_indices[j] = index;
+			previous = job;
+			tail = j;
+			auto &dependents = entries[j].dependents;
+			j = dependents.size() == 1 && fused_predecessors[dependents[0]] == j ? dependents[0] : -1;
+		}
+		compiled[index].jobs_end = compiled_jobs.size();
+		compiled_tails.push_back(tail);
+	}
+	//Only the last job of a chain has dependents outside it.
+	for(int index = 0; index < compiled.size(); index++) {
+		auto &e = entries[compiled_tails[index]];
+		auto &c = compiled[index];
+		c.dependents_begin = compiled_dependents.size();
+		//Culled jobs never have dependencies, so everything here runs.
+		for(auto d: e.dependents) compiled_dependents.push_back(compiled_indices[d]);
+		c.dependents_end = compiled_dependents.size();
+		if(c.dependency_count == 0) roots.push_back(index);
+		if(e.dependents.size() > 1) max_parallelism += e.dependents.size()-1;
+	}
+	max_parallelism += roots.size();
+	if(remaining_dependencies_capacity < compiled.size()) {
+		remaining_dependencies.reset(new std::atomic<int>[compiled.size()]);
+		remaining_dependencies_capacity = compiled.size();
+	}
+	//Kahn's algorithm, for prioritize.
+	compiled_order.clear();
+	for(int i = 0; i < compiled.size(); i++) remaining_dependencies[i].store(compiled[i].dependency_count, std::memory_order_relaxed);
+	for(auto r: roots) compiled_order.push_back(r);
+	for(int i = 0; i < compiled_order.size(); i++) {
+		auto &c = compiled[compiled_order[i]];
+		for(int j = c.dependents_begin; j < c.dependents_end; j++) {
+			int d = compiled_dependents[j];
+			if(remaining_dependencies[d].fetch_sub(1, std::memory_order_relaxed) == 1) compiled_order.push_back(d);
+		}
+	}
+	compiled_generation = generation;
+	prioritize();
+}
+
+void Planner::prioritize() {
+	blocks_since_prioritizing = 0;
+	priorities.assign(compiled.size(), 0.0);
+	compiled_costs.assign(compiled.size(), 0.0);
+	critical_path_cost = 0.0;
+	for(int i = compiled_order.size()-1; i >= 0; i--) {
+		int index = compiled_order[i];
+		auto &c = compiled[index];
+		for(int j = c.jobs_begin; j < c.jobs_end; j++) compiled_costs[index] += compiled_jobs[j]->average_cost;
+		double longest = 0.0;
+		for(int j = c.dependents_begin; j < c.dependents_end; j++) longest = std::max(longest, priorities[compiled_dependents[j]]);
+		priorities[index] = compiled_costs[index]+longest;
+		critical_path_cost = std::max(critical_path_cost, priorities[index]);
 	}
+	auto lower = [&] (int a, int b) {return priorities[a] < priorities[b];};
+	for(auto &c: compiled) std::sort(compiled_dependents.begin()+c.dependents_begin, compiled_dependents.begin()+c.dependents_end, lower);
+	std::sort(roots.begin(), roots.end(), [&] (int a, int b) {return priorities[a] > priorities[b];});
 }
 
 }
\ No newline at end of file
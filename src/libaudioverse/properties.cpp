@@ -12,6 +12,7 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/node.hpp>
 #include <libaudioverse/private/server.hpp>
 #include <libaudioverse/private/connections.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <stdlib.h>
 #include <string.h>
 #include <algorithm>
@@ -22,6 +23,7 @@ Property::Property(int property_type): type(property_type) {}
 
 Property::~Property() {
 	if(value_buffer) freeArray(value_buffer);
+	if(float_value_buffer) freeArray(float_value_buffer);
 	if(node_buffer) freeArray(node_buffer);
 	if(buffer_value) buffer_value->decrementUseCount();
 }
@@ -31,12 +33,28 @@ void Property::associateNode(Node* node) {
 	block_size=node->getServer()->getBlockSize();
 	sr = node->getServer()->getSr();
 	if(type==Lav_PROPERTYTYPE_FLOAT || type == Lav_PROPERTYTYPE_DOUBLE) {
-		value_buffer= allocArray<double>(block_size);
-		node_buffer = allocArray<float>(block_size);
 		incoming_nodes=std::make_shared<InputConnection>(node->getServer(), nullptr, 0, 1);
 	}
 }
 
+void Property::allocateBuffers() {
+	if(value_buffer) return;
+	value_buffer= allocArray<double>(block_size);
+	if(type == Lav_PROPERTYTYPE_FLOAT) float_value_buffer = allocArray<float>(block_size);
+	node_buffer = allocArray<float>(block_size);
+}
+
+void Property::reserveAutomator() {
+	allocateBuffers();
+	reserved_automators++;
+	size_t needed = automators.size()+reserved_automators;
+	if(automators.capacity() < needed) automators.reserve(std::max(needed, 2*automators.capacity()));
+}
+
+Node* Property::getAssociatedNode() {
+	return node;
+}
+
 void Property::associateServer(std::shared_ptr<Server> server) {
 	this->server = server;
 }
@@ -48,7 +66,7 @@ void Property::reset(bool avoidCallbacks) {
 	iarray_value = default_iarray_value;
 	if(buffer_value) buffer_value->decrementUseCount();
 	buffer_value=nullptr;
-	automators.clear();
+	retireAutomators(automators.begin());
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -92,6 +110,12 @@ std::shared_ptr<InputConnection> Property::getInputConnection() {
 	return incoming_nodes;
 }
 
+void Property::markModified() {
+	last_modified = server->getTickCount();
+	//A sleeping node wouldn't see this until something else woke it.
+	if(node) node->wake();
+}
+
 bool Property::wasModified() {
 	return was_modified;
 }
@@ -105,7 +129,13 @@ void Property::updateAutomatorIndex(double t) {
 	}
 }
 
-void Property::scheduleAutomator(Automator* automator) {
+void Property::scheduleAutomator(Automator* automator, bool reserved) {
+	allocateBuffers();
+	if(reserved && reserved_automators > 0) reserved_automators--;
+	//Keep the room for queued automators.
+	size_t needed = automators.size()+reserved_automators+1;
+	if(automators.capacity() < needed) automators.reserve(std::max(needed, 2*automators.capacity()));
+	if(node) node->wake();
 	//find iterators bracketting where we want to insert.
 	auto lower = std::lower_bound(automators.begin(), automators.end(), automator, compareAutomators);
 	auto upper = std::upper_bound(automators.begin(), automators.end(), automator, compareAutomators);
@@ -144,6 +174,10 @@ void Property::scheduleAutomator(Automator* automator) {
 	automator_index = 0;
 }
 
+bool Property::isAutomated() {
+	return automators.empty() == false;
+}
+
 void Property::cancelAutomators(double time) {
 	if(type != Lav_PROPERTYTYPE_FLOAT && type != Lav_PROPERTYTYPE_DOUBLE) ERROR(Lav_ERROR_TYPE_MISMATCH, "Only float and double properties have automators.");
 	double currentValue = type == Lav_PROPERTYTYPE_FLOAT ? getFloatValue(0) : getDoubleValue(0); //shold onto this.
@@ -154,7 +188,7 @@ void Property::cancelAutomators(double time) {
 		if(a->getScheduledTime() > time) break;
 		b++;
 	}
-	if(b != automators.end()) automators.erase(b, automators.end());
+	retireAutomators(b);
 	//If the automators vector is empty, we need to use the cached value.
 	if(automators.empty()) type==Lav_PROPERTYTYPE_FLOAT ? value.fval = currentValue : value.dval = currentValue;
 	//The automator index may now be wrong.
@@ -162,6 +196,11 @@ void Property::cancelAutomators(double time) {
 	automator_index = 0;
 }
 
+void Property::retireAutomators(std::vector<Automator*>::iterator first) {
+	for(auto i = first; i != automators.end(); i++) server->retire(*i);
+	automators.erase(first, automators.end());
+}
+
 bool Property::isReadOnly() {
 	return read_only;
 }
@@ -170,6 +209,36 @@ void Property::setReadOnly(bool what) {
 	read_only = what;
 }
 
+bool Property::isInRange(double v) {
+	//RC doesn't check these.
+	if(read_only) return true;
+	if(type == Lav_PROPERTYTYPE_INT) return v >= minimum_value.ival && v <= maximum_value.ival;
+	else if(type == Lav_PROPERTYTYPE_FLOAT) return v >= minimum_value.fval && v <= maximum_value.fval;
+	else if(type == Lav_PROPERTYTYPE_DOUBLE) return v >= minimum_value.dval && v <= maximum_value.dval;
+	return true;
+}
+
+PropertySlotInfo::PropertySlotInfo(Property &prop): type(prop.getType()), read_only(prop.isReadOnly()), has_dynamic_range(prop.getHasDynamicRange()) {
+	if(type == Lav_PROPERTYTYPE_INT) {
+		minimum = prop.getIntMin();
+		maximum = prop.getIntMax();
+	}
+	else if(type == Lav_PROPERTYTYPE_FLOAT) {
+		minimum = prop.getFloatMin();
+		maximum = prop.getFloatMax();
+	}
+	else if(type == Lav_PROPERTYTYPE_DOUBLE) {
+		minimum = prop.getDoubleMin();
+		maximum = prop.getDoubleMax();
+	}
+}
+
+bool PropertySlotInfo::isInRange(double v) const {
+	if(read_only) return true;
+	if(type == Lav_PROPERTYTYPE_INT || type == Lav_PROPERTYTYPE_FLOAT || type == Lav_PROPERTYTYPE_DOUBLE) return v >= minimum && v <= maximum;
+	return true;
+}
+
 int Property::getIntValue() {
 	return value.ival;
 }
@@ -177,7 +246,7 @@ int Property::getIntValue() {
 void Property::setIntValue(int v, bool avoidCallbacks) {
 	RC(v, ival);
 	value.ival = v;
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }	
 
@@ -204,15 +273,19 @@ void Property::setIntRange(int a, int b) {
 
 
 float Property::getFloatValue(int i) {
-	if(should_use_value_buffer) return value_buffer[i];
+	if(should_use_value_buffer) return float_value_buffer ? float_value_buffer[i] : value_buffer[i];
 	else return value.fval;
 }
 
+float* Property::getFloatValueBuffer() {
+	return needsARate() ? float_value_buffer : nullptr;
+}
+
 void Property::setFloatValue(float v, bool avoidCallbacks, bool avoidAutomatorClear) {
 	RC(v, fval);
-	if(avoidAutomatorClear == false) automators.clear();
+	if(avoidAutomatorClear == false) retireAutomators(automators.begin());
 	value.fval = v;
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -238,15 +311,15 @@ void Property::setFloatRange(float a, float b) {
 
 //doubles...
 double Property::getDoubleValue(int i) {
-	if(should_use_value_buffer) return value_buffer[i];
+	if(should_use_value_buffer) return float_value_buffer ? float_value_buffer[i] : value_buffer[i];
 	else return value.dval;
 }
 
 void Property::setDoubleValue(double v, bool avoidCallbacks, bool avoidAutomatorClear) {
 	RC(v, dval);
-	if(avoidAutomatorClear == false) automators.clear();
+	if(avoidAutomatorClear == false) retireAutomators(automators.begin());
 	value.dval = v;
-	last_modified =server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -277,7 +350,7 @@ const float* Property::getFloat3Default() {
 
 void Property::setFloat3Value(const float* const v, bool avoidCallbacks) {
 	memcpy(value.f3val, v, sizeof(float)*3);
-	last_modified = server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -285,7 +358,7 @@ void Property::setFloat3Value(float v1, float v2, float v3, bool avoidCallbacks)
 	value.f3val[0] = v1;
 	value.f3val[1] = v2;
 	value.f3val[2] = v3;
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -309,7 +382,7 @@ const float* Property::getFloat6Default() {
 
 void Property::setFloat6Value(const float* const v, bool avoidCallbacks) {
 	memcpy(&value.f6val, v, sizeof(float)*6);
-	last_modified = server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -320,7 +393,7 @@ void Property::setFloat6Value(float v1, float v2, float v3, float v4, float v5,
 	value.f6val[3] = v4;
 	value.f6val[4] = v5;
 	value.f6val[5] = v6;
-	last_modified =server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -373,7 +446,7 @@ void Property::writeFloatArray(unsigned int start, unsigned int stop, float* val
 	for(unsigned int i = start; i < stop; i++) {
 		farray_value[i] = values[i];
 	}
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -387,7 +460,7 @@ void Property::replaceFloatArray(unsigned int length, float* values, bool avoidC
 	}
 	farray_value.resize(length);
 	std::copy(values, values+length, farray_value.begin());
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -421,7 +494,7 @@ void Property::writeIntArray(unsigned int start, unsigned int stop, int* values,
 	for(unsigned int i = start; i < stop; i++) {
 		iarray_value[i] = values[i];
 	}
-	last_modified = server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -435,7 +508,7 @@ void Property::replaceIntArray(unsigned int length, int* values, bool avoidCallb
 	}
 	iarray_value.resize(length);
 	std::copy(values, values+length, iarray_value.begin());
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -462,7 +535,7 @@ const char* Property::getStringValue() {
 
 void Property::setStringValue(const char* s, bool avoidCallbacks) {
 	string_value = s;
-	last_modified=server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -482,7 +555,7 @@ void Property::setBufferValue(std::shared_ptr<Buffer> b, bool avoidCallbacks) {
 	if(buffer_value) buffer_value->decrementUseCount();
 	buffer_value=b;
 	if(b) b->incrementUseCount();
-	last_modified = server->getTickCount();
+	markModified();
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
@@ -506,27 +579,34 @@ void Property::tick() {
 		should_use_value_buffer = true;
 		double last;
 		last=automators[automator_index]->getFinalValue(); //start this.
-		//We need to compute it.
-		for(int i = 0; i < block_size; i++) {
+		//Each automator renders the run of samples for which it's current in one go.
+		int i = 0;
+		while(i < block_size) {
 			updateAutomatorIndex(time+i/sr);
-			if(automator_index != automators.size()) {
-				value_buffer[i]=automators[automator_index]->getValue(time+i/sr);
-				last = automators[automator_index]->getFinalValue();
+			if(automator_index == automators.size()) {
+				std::fill(value_buffer+i, value_buffer+block_size, last);
+				break;
 			}
-			else value_buffer[i] = last;
+			auto a = automators[automator_index];
+			int end = firstSampleAtOrAfter(a->getScheduledTime()+a->getDuration(), time, sr, i+1, block_size);
+			a->renderBlock(time, sr, i, end-i, value_buffer);
+			last = a->getFinalValue();
+			i = end;
 		}
+		if(float_value_buffer) doubleToFloatKernel(block_size, value_buffer, float_value_buffer);
 		was_modified = true;
 	}
-	//We might have nodes:
-	if(incoming_nodes->getConnectedNodeCount()) {
+	//We might have nodes. If they're all silent, they'd add nothing.
+	if(incoming_nodes->getConnectedNodeCount() && incoming_nodes->isSilent() == false) {
 		//If should_use_value_buffer is false, we haven't set it to fval or dval yet.
 		if(should_use_value_buffer== false) {
-			double needed = type == Lav_PROPERTYTYPE_FLOAT ? value.fval : value.dval;
-			std::fill(value_buffer, value_buffer+block_size, needed);
+			if(float_value_buffer) std::fill(float_value_buffer, float_value_buffer+block_size, value.fval);
+			else std::fill(value_buffer, value_buffer+block_size, value.dval);
 		}
 		memset(node_buffer, 0, block_size*sizeof(float));
 		incoming_nodes->addNodeless(&node_buffer, true); //downmix to mono.
-		for(int i = 0; i < block_size; i++) value_buffer[i]+=node_buffer[i];
+		if(float_value_buffer) additionKernel(block_size, float_value_buffer, node_buffer, float_value_buffer);
+		else for(int i = 0; i < block_size; i++) value_buffer[i]+=node_buffer[i];
 		should_use_value_buffer =true;
 		was_modified=true;
 	}
@@ -540,8 +620,7 @@ void Property::tick() {
 		if(a.getScheduledTime()+a.getDuration() < time) {
 			if(type == Lav_PROPERTYTYPE_FLOAT) value.fval = a.getFinalValue();
 			else value.dval = a.getFinalValue();
-			for(auto i = automators.begin(); i != automators.end(); i++) delete *i;
-			automators.clear();
+			retireAutomators(automators.begin());
 			automator_index = 0;
 		}
 	}
@@ -0,0 +1,181 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Impulse response spectra, and the cache that lets convolvers with the same response share them.*/
+#include <libaudioverse/private/response_spectra.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+namespace libaudioverse_implementation {
+
+ResponseSpectrum::ResponseSpectrum(int fftSize, int partitionSize, int length, const float* response): fft_size(fftSize), partition_size(partitionSize), length(length) {
+	partition_count = (length+partition_size-1)/partition_size;
+	bin_count = fft_size/2+1;
+	stride = (bin_count+15)/16*16;
+	samples = allocArray<float>(length);
+	std::copy(response, response+length, samples);
+	real = allocArray<float>(stride*partition_count);
+	imag = allocArray<float>(stride*partition_count);
+	Fft fft(fft_size);
+	float* workspace = allocArray<float>(fft_size);
+	for(int i = 0; i < partition_count; i++) {
+		int start = i*partition_size;
+		int count = std::min(partition_size, length-start);
+		std::fill(workspace, workspace+fft_size, 0.0f);
+		std::copy(response+start, response+start+count, workspace);
+		fft.forward(workspace, real+i*stride, imag+i*stride);
+	}
+	freeArray(workspace);
+}
+
+ResponseSpectrum::~ResponseSpectrum() {
+	freeArray(samples);
+	freeArray(real);
+	freeArray(imag);
+}
+
+int ResponseSpectrum::getFftSize() {
+	return fft_size;
+}
+
+int ResponseSpectrum::getPartitionSize() {
+	return partition_size;
+}
+
+int ResponseSpectrum::getPartitionCount() {
+	return partition_count;
+}
+
+int ResponseSpectrum::getBinCount() {
+	return bin_count;
+}
+
+float* ResponseSpectrum::getReal(int partition) {
+	return real+partition*stride;
+}
+
+float* ResponseSpectrum::getImag(int partition) {
+	return imag+partition*stride;
+}
+
+bool ResponseSpectrum::matches(int fftSize, int partitionSize, int length, const float* response) {
+	return fftSize == fft_size && partitionSize == partition_size && length == this->length
+	&& memcmp(response, samples, sizeof(float)*length) == 0;
+}
+
+long long ResponseSpectrum::getByteCount() {
+	return sizeof(float)*(length+2LL*stride*partition_count);
+}
+
+//FNV-1a, a word at a time. Collisions only cost a comparison.
+unsigned long long hashResponse(int fftSize, int partitionSize, int length, const float* response) {
+	unsigned long long hash = 14695981039346656037ULL;
+	auto mix = [&] (unsigned int word) {
+		hash ^= word;
+		hash *= 1099511628211ULL;
+	};
+	mix(fftSize);
+	mix(partitionSize);
+	mix(length);
+	for(int i = 0; i < length; i++) {
+		unsigned int word;
+		memcpy(&word, response+i, sizeof(word));
+		mix(word);
+	}
+	return hash;
+}
+
+//Weak, so that the cache never keeps a response alive on its own.
+std::multimap<unsigned long long, std::weak_ptr<ResponseSpectrum>> *response_spectrum_cache;
+std::mutex *response_spectrum_cache_mutex;
+
+void initializeResponseSpectrumCache() {
+	response_spectrum_cache = new std::multimap<unsigned long long, std::weak_ptr<ResponseSpectrum>>();
+	response_spectrum_cache_mutex = new std::mutex();
+}
+
+void shutdownResponseSpectrumCache() {
+	delete response_spectrum_cache_mutex;
+	delete response_spectrum_cache;
+	response_spectrum_cache_mutex = nullptr;
+	response_spectrum_cache = nullptr;
+}
+
+//Needs the lock.
+//Anything this locks might have lost every other owner meanwhile, and its deleter takes the lock, so it goes in keep to die after the caller lets go.
+std::shared_ptr<ResponseSpectrum> findResponseSpectrum(unsigned long long hash, int fftSize, int partitionSize, int length, const float* response, std::vector<std::shared_ptr<ResponseSpectrum>> &keep) {
+	auto range = response_spectrum_cache->equal_range(hash);
+	for(auto i = range.first; i != range.second; i++) {
+		auto spectrum = i->second.lock();
+		if(spectrum == nullptr) continue;
+		keep.push_back(spectrum);
+		if(spectrum->matches(fftSize, partitionSize, length, response)) return spectrum;
+	}
+	return nullptr;
+}
+
+//Called as a spectrum dies, so that the cache stays as big as the set of live responses without anyone having to sweep it.
+void forgetResponseSpectrum(unsigned long long hash) {
+	if(response_spectrum_cache == nullptr) return;
+	std::lock_guard<std::mutex> guard(*response_spectrum_cache_mutex);
+	auto range = response_spectrum_cache->equal_range(hash);
+	for(auto i = range.first; i != range.second;) {
+		if(i->second.expired()) i = response_spectrum_cache->erase(i);
+		else i++;
+	}
+}
+
+std::shared_ptr<ResponseSpectrum> getResponseSpectrum(int fftSize, int partitionSize, int length, const float* response) {
+	auto hash = hashResponse(fftSize, partitionSize, length, response);
+	std::vector<std::shared_ptr<ResponseSpectrum>> keep;
+	std::shared_ptr<ResponseSpectrum> existing;
+	{
+		std::lock_guard<std::mutex> guard(*response_spectrum_cache_mutex);
+		existing = findResponseSpectrum(hash, fftSize, partitionSize, length, response, keep);
+	}
+	if(existing) return existing;
+	//Nothing to share. Making one is an fft per partition, so do it without holding up every other convolver in the process.
+	std::shared_ptr<ResponseSpectrum> spectrum(new ResponseSpectrum(fftSize, partitionSize, length, response), [hash] (ResponseSpectrum* s) {
+		delete s;
+		forgetResponseSpectrum(hash);
+	});
+	{
+		std::lock_guard<std::mutex> guard(*response_spectrum_cache_mutex);
+		//Someone else might have made the same one meanwhile.
+		existing = findResponseSpectrum(hash, fftSize, partitionSize, length, response, keep);
+		if(existing == nullptr) response_spectrum_cache->emplace(hash, spectrum);
+	}
+	//If ours lost, it goes here, outside the lock, along with keep.
+	return existing ? existing : spectrum;
+}
+
+void getResponseSpectrumCacheUsage(int &count, long long &bytes) {
+	//As in findResponseSpectrum, nothing locked here may die until the lock is released.
+	std::vector<std::shared_ptr<ResponseSpectrum>> keep;
+	count = 0;
+	bytes = 0;
+	{
+		std::lock_guard<std::mutex> guard(*response_spectrum_cache_mutex);
+		keep.reserve(response_spectrum_cache->size());
+		for(auto &i: *response_spectrum_cache) {
+			auto spectrum = i.second.lock();
+			if(spectrum == nullptr) continue;
+			count++;
+			bytes += spectrum->getByteCount();
+			keep.push_back(std::move(spectrum));
+		}
+	}
+}
+
+}
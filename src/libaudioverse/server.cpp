@@ -18,9 +18,14 @@ carrying such notice may not be copied, modified, or distributed except accordin
 #include <libaudioverse/private/planner.hpp>
 #include <libaudioverse/private/logging.hpp>
 #include <libaudioverse/private/helper_templates.hpp>
+#include <libaudioverse/private/properties.hpp>
+#include <libaudioverse/private/automators.hpp>
+#include <libaudioverse/private/error.hpp>
+#include <powercores/exceptions.hpp>
 #include <powercores/utilities.hpp>
 #include <audio_io/audio_io.hpp>
 #include <stdlib.h>
+#include <math.h>
 #include <functional>
 #include <algorithm>
 #include <iterator>
@@ -30,11 +35,17 @@ carrying such notice may not be copied, modified, or distributed except accordin
 
 namespace libaudioverse_implementation {
 
+//How many calls can be scheduled while rendering before scheduleCall gives up on not allocating.
+const int deferred_callback_capacity = 256;
+
 Server::Server(unsigned int sr, unsigned int blockSize, unsigned int mixahead): Job(Lav_OBJTYPE_SERVER) {
 	if(blockSize%4 || blockSize== 0) ERROR(Lav_ERROR_RANGE, "Block size must be a nonzero multiple of 4."); //only afe to have this be a multiple of four.
 	this->sr = (float)sr;
 	this->block_size = blockSize;
 	this->mixahead = mixahead;
+	property_commands = new powercores::MpmcQueue<PropertyCommand>(4096);
+	deferred_callbacks.reserve(deferred_callback_capacity);
+	due_callbacks.reserve(deferred_callback_capacity);
 	//fire up the background thread.
 	backgroundTaskThread = powercores::safeStartThread(&Server::backgroundTaskThreadFunction, this);
 	planner = new Planner();
@@ -54,16 +65,47 @@ void Server::completeInitialization() {
 	final_output_connection =std::make_shared<InputConnection>(std::static_pointer_cast<Server>(this->shared_from_this()), nullptr, 0, 0);
 }
 
+//Set when a server is destroyed from its own background thread, which happens when freeing a retired topology commit, emptying the graveyard, or finishing a task lets go of the last node holding it.
+thread_local bool background_thread_orphaned = false;
+
 Server::~Server() {
 	clearOutputDevice();
-	//enqueue a task which will stop the background thread.
-	enqueueTask([]() {throw ThreadTerminationException();});
-	backgroundTaskThread.join();
+	if(std::this_thread::get_id() == backgroundTaskThread.get_id()) {
+		//The thread can't join itself; it notices the flag and exits without touching us again.
+		background_thread_orphaned = true;
+		backgroundTaskThread.detach();
+	}
+	else {
+		//enqueue a task which will stop the background thread.
+		enqueueTask([]() {throw ThreadTerminationException();});
+		backgroundTaskThread.join();
+	}
+	//Nothing will apply these now.
+	auto commit = published_topology_commits.exchange(nullptr);
+	while(commit) {
+		auto next = commit->next;
+		delete commit;
+		commit = next;
+	}
+	freeRetiredTopologyCommits();
+	//The nodes these were for are gone, but the automators are still ours.
+	PropertyCommand command;
+	while(property_commands->dequeue(command)) {
+		if(command.automator) delete command.automator;
+	}
+	delete property_commands;
+	freeRetired();
 	delete planner;
+	//Other servers might still want it locked; this only lets go of ours.
+	if(locked_memory) lockProcessMemory(false);
 }
 
 //Yes, this uses goto. Yes, goto is evil. We need a single point of exit.
 void Server::getBlock(float* out, unsigned int channels, bool mayApplyMixingMatrix) {
+	//Covers the callbacks too, since they can let go of things.
+	RenderingScope rendering;
+	applyTopologyCommits();
+	applyPropertyCommands();
 	if(out == nullptr || channels == 0) {
 		memset(out, 0, sizeof(float)*channels*block_size);
 		goto end;
@@ -74,15 +116,21 @@ void Server::getBlock(float* out, unsigned int channels, bool mayApplyMixingMatr
 	//append buffers to the final_outputs vector until it's big enough.
 	//in a sane application, we'll never go above 8 channels so keeping them around is no big deal.
 	while(final_outputs.size() < channels) final_outputs.push_back(allocArray<float>(block_size));
-	//zero the outputs we need.
-	for(unsigned int i= 0; i < channels; i++) memset(final_outputs[i], 0, sizeof(float)*block_size);
 	//Inform nodes that we are going to tick.
 	for(auto &i: will_tick_nodes) {
 		auto n = i.lock();
 		if(n) n->willTick();
 	}
 	//Use the planner.
-	planner->execute(std::dynamic_pointer_cast<Job>(shared_from_this()), threads);
+	planner->execute(std::static_pointer_cast<Job>(shared_from_this()), threads);
+	//Only skips the output mix: whether a node is silent isn't known until it has run, so everything above still happens.
+	//Sleeping and paused nodes are culled by the planner instead.
+	if(final_output_connection->isSilent()) {
+		memset(out, 0, sizeof(float)*channels*block_size);
+		goto end;
+	}
+	//zero the outputs we need.
+	for(unsigned int i= 0; i < channels; i++) memset(final_outputs[i], 0, sizeof(float)*block_size);
 	//write, applying mixing matrices as needed.
 	final_output_connection->addNodeless(&final_outputs[0], true);
 	//interleave the samples.
@@ -99,13 +147,28 @@ void Server::getBlock(float* out, unsigned int channels, bool mayApplyMixingMatr
 	if(maintenance_start%maintenance_rate == 0) doMaintenance();
 	tick_count ++;
 	//Finally, we have to call any scheduled callbacks for this block.
-	filter(scheduled_callbacks, [&](auto item, double t) {
-		if(t >= item.first) {
-			item.second();
-			return false; //to kill.
-		}
-		else return true; //to keep.
-	}, getCurrentTime());
+	scheduled_callbacks.advance(tick_count, [&](ScheduledCallback &c) {
+		due_callbacks.push_back(std::move(c));
+	});
+	if(deferred_callbacks.size()) {
+		uint64_t now = tick_count;
+		auto later = std::partition(deferred_callbacks.begin(), deferred_callbacks.end(), [&](const std::pair<uint64_t, ScheduledCallback> &c) {return c.first <= now;});
+		for(auto i = deferred_callbacks.begin(); i != later; i++) due_callbacks.push_back(std::move(i->second));
+		deferred_callbacks.erase(deferred_callbacks.begin(), later);
+	}
+	//The wheel only knows blocks, so put them back in order. This sorts in place, unlike std::stable_sort.
+	std::sort(due_callbacks.begin(), due_callbacks.end(), [](const ScheduledCallback &a, const ScheduledCallback &b) {
+		return a.time < b.time || (a.time == b.time && a.sequence < b.sequence);
+	});
+	//So the ones which are due come first. Anything after them is a block early from rounding, and stays for the next block.
+	unsigned int ran = 0;
+	while(ran < due_callbacks.size() && time >= due_callbacks[ran].time) {
+		//If deferred_callbacks is full, scheduling more can move due_callbacks, so take it out first.
+		auto callback = std::move(due_callbacks[ran].callback);
+		ran++;
+		callback();
+	}
+	due_callbacks.erase(due_callbacks.begin(), due_callbacks.begin()+ran);
 }
 
 void Server::doMaintenance() {
@@ -129,6 +192,8 @@ void Server::setOutputDevice(int index, int channels, int mixahead) {
 		if(strong==nullptr) memset(buffer, 0, sizeof(float)*blockSize*channels);
 		else {
 			std::lock_guard<Server> guard(*strong);
+			//This thread belongs to the device, so it can stay an audio thread between blocks.
+			becomeAudioThread(strong->getAudioThreadConfiguration(), 0, true);
 			strong->getBlock(buffer, channels);
 		}
 	};
@@ -161,6 +226,10 @@ LavError Server::stop() {
 
 void Server::associateNode(std::shared_ptr<Node> node) {
 	nodes.insert(std::weak_ptr<Node>(node));
+	//Dead nodes stay in nodes until maintenance, so this overestimates; the server is the extra job.
+	planner->reserve(nodes.size()+1, threads);
+	//Subclasses can turn pooling off in their constructors, after resize last asked.
+	updateBufferPooling(node.get());
 }
 
 void Server::registerNodeForWillTick(std::shared_ptr<Node> node) {
@@ -169,10 +238,12 @@ void Server::registerNodeForWillTick(std::shared_ptr<Node> node) {
 
 void Server::registerNodeForAlwaysPlaying(std::shared_ptr<Node> which) {
 	always_playing_nodes.insert(which);
+	invalidateDependencies(this);
 }
 
 void Server::unregisterNodeForAlwaysPlaying(std::shared_ptr<Node> which) {
 	always_playing_nodes.erase(which);
+	invalidateDependencies(this);
 }
 
 void Server::registerNodeForMaintenance(std::shared_ptr<Node> which) {
@@ -183,12 +254,32 @@ void Server::enqueueTask(std::function<void(void)> cb) {
 	tasks.enqueue(cb);
 }
 
+//How often the background thread frees retired topology commits and empties the graveyard if it has nothing else to do.
+//Retired automators and the like go at the same time.
+const int retired_topology_commit_interval = 50;
+
 //Default callback implementation.
 void Server::backgroundTaskThreadFunction() {
 	try {
 		for(;;) {
-			auto task = tasks.dequeue();
+			freeRetiredTopologyCommits();
+			if(background_thread_orphaned) return;
+			emptyGraveyard();
+			if(background_thread_orphaned) return;
+			freeRetired();
+			scheduleDeferredCallbacks();
+			logDroppedPropertyCommands();
+			std::function<void(void)> task;
+			try {
+				task = tasks.dequeueWithTimeout(retired_topology_commit_interval);
+			}
+			catch(powercores::TimeoutException &e) {
+				continue;
+			}
 			task();
+			//Destroying the task's captures can also let go of the server.
+			task = nullptr;
+			if(background_thread_orphaned) return;
 		}
 	}
 	catch(ThreadTerminationException) {
@@ -219,22 +310,287 @@ void Server::writeFile(std::string path, int channels, double duration, bool may
 
 void Server::setThreads(int n) {
 	threads = n;
+	planner->reserveBufferPool(buffer_pool_width, threads);
+	planner->reserve(nodes.size()+1, threads);
+	for(auto &i: nodes) {
+		auto node = i.lock();
+		if(node) node->threadsChanged(threads);
+	}
 }
 
 int Server::getThreads() {
 	return threads;
 }
 
+int Server::getCurrentWorker() {
+	return Planner::getCurrentWorker();
+}
+
+void Server::setSchedulingPolicy(int policy, int priority) {
+	audio_thread_configuration.scheduling_policy = policy;
+	audio_thread_configuration.priority = priority;
+	audio_thread_configuration.markChanged();
+	planner->setAudioThreadConfiguration(audio_thread_configuration);
+}
+
+void Server::setCpuAffinity(std::vector<int> cpus) {
+	audio_thread_configuration.cpus = cpus;
+	audio_thread_configuration.markChanged();
+	planner->setAudioThreadConfiguration(audio_thread_configuration);
+}
+
+void Server::setFlushDenormals(bool flush) {
+	audio_thread_configuration.flush_denormals = flush;
+	audio_thread_configuration.markChanged();
+	planner->setAudioThreadConfiguration(audio_thread_configuration);
+}
+
+void Server::setLockMemory(bool lock) {
+	if(lock == locked_memory) return;
+	if(lockProcessMemory(lock) == false) ERROR(Lav_ERROR_MEMORY, lock ? "Could not lock memory. On Linux, check RLIMIT_MEMLOCK." : "Could not unlock memory.");
+	locked_memory = lock;
+}
+
+const AudioThreadConfiguration& Server::getAudioThreadConfiguration() {
+	return audio_thread_configuration;
+}
+
+double Server::getCriticalPathCost() {
+	return planner->getCriticalPathCost();
+}
+
+void Server::setBufferPooling(bool pooling) {
+	buffer_pooling = pooling;
+	planner->setBufferPooling(pooling, block_size);
+	for(auto &i: nodes) {
+		auto node = i.lock();
+		if(node) updateBufferPooling(node.get());
+	}
+}
+
+void Server::updateBufferPooling(Node* node) {
+	int old = node->getPooledBufferCount();
+	int width = node->usePooledBuffers(buffer_pooling);
+	//The plan was compiled for the old buffers.
+	if(width != old) invalidateDependencies(node);
+	buffer_pool_width = std::max(buffer_pool_width, width);
+	planner->reserveBufferPool(buffer_pool_width, threads);
+}
+
 void Server::invalidatePlan() {
 	planner->invalidatePlan();
 }
 
+void Server::invalidateDependencies(Job* job) {
+	planner->invalidateDependencies(job);
+}
+
+void Server::invalidateDependents(Job* job) {
+	planner->invalidateDependents(job);
+}
+
+void Server::invalidateDependenciesFromJob(Job* job) {
+	planner->invalidateDependenciesFromJob(job);
+}
+
+void Server::commitTopology(TopologyCommit* commit) {
+	for(auto &i: commit->snapshots) i.second = i.first->makeSnapshot();
+	//We hold the topology mutex, so commits go on in the order their snapshots were made.
+	commit->next = published_topology_commits.load(std::memory_order_relaxed);
+	while(published_topology_commits.compare_exchange_weak(commit->next, commit, std::memory_order_release, std::memory_order_relaxed) == false);
+}
+
+void Server::applyTopologyCommits() {
+	auto commit = published_topology_commits.exchange(nullptr, std::memory_order_acquire);
+	if(commit == nullptr) return;
+	//Newest first, so reverse it.
+	TopologyCommit* oldest = nullptr;
+	while(commit) {
+		auto next = commit->next;
+		commit->next = oldest;
+		oldest = commit;
+		commit = next;
+	}
+	commit = oldest;
+	TopologyCommit* last = nullptr;
+	while(commit) {
+		for(auto &i: commit->snapshots) i.second = i.first->swapSnapshot(i.second);
+		for(auto &j: commit->changed_dependencies) invalidateDependencies(j.get());
+		for(auto &j: commit->changed_dependents) invalidateDependents(j.get());
+		if(commit->server_changed) invalidateDependencies(this);
+		last = commit;
+		commit = commit->next;
+	}
+	//The commits hold the old snapshots and the last references to anything disconnected, so somebody else has to free them.
+	last->next = retired_topology_commits.load(std::memory_order_relaxed);
+	while(retired_topology_commits.compare_exchange_weak(last->next, oldest, std::memory_order_release, std::memory_order_relaxed) == false);
+}
+
+void Server::freeRetiredTopologyCommits() {
+	auto commit = retired_topology_commits.exchange(nullptr, std::memory_order_acquire);
+	while(commit) {
+		auto next = commit->next;
+		//This can destroy nodes, which takes the lock.
+		delete commit;
+		commit = next;
+	}
+}
+
+void Server::setQueuePropertyWrites(bool queue) {
+	queue_property_writes = queue;
+	//Anything already queued has to happen before the writes that now take the lock.
+	if(queue == false) applyPropertyCommands();
+}
+
+bool Server::getQueuePropertyWrites() {
+	return queue_property_writes;
+}
+
+bool Server::enqueuePropertyCommand(const PropertyCommand &command) {
+	if(property_commands->enqueue(command)) return true;
+	//Full. Apply what's there, so that the caller's earlier writes still happen before this one.
+	LOCK(*this);
+	applyPropertyCommands();
+	return false;
+}
+
+void Server::applyPropertyCommands() {
+	PropertyCommand command;
+	while(property_commands->dequeue(command)) {
+		auto n = command.node.lock();
+		if(n == nullptr) {
+			if(command.automator) retire(command.automator);
+			continue;
+		}
+		//Blocks which finished after the call, not counting the one which was running.
+		//With the lock, the call would have waited for that one anyway.
+		int lateBlocks = std::max(0, tick_count-command.tick-1);
+		double time = std::max(0.0, command.time-lateBlocks*block_size/sr);
+		try {
+			auto &prop = n->getProperty(command.slot);
+			switch(command.kind) {
+				case PropertyCommandKinds::SET:
+				if(command.type == Lav_PROPERTYTYPE_INT) prop.setIntValue((int)command.values[0]);
+				else if(command.type == Lav_PROPERTYTYPE_FLOAT) prop.setFloatValue((float)command.values[0]);
+				else if(command.type == Lav_PROPERTYTYPE_DOUBLE) prop.setDoubleValue(command.values[0]);
+				else if(command.type == Lav_PROPERTYTYPE_FLOAT3) prop.setFloat3Value((float)command.values[0], (float)command.values[1], (float)command.values[2]);
+				else if(command.type == Lav_PROPERTYTYPE_FLOAT6) prop.setFloat6Value((float)command.values[0], (float)command.values[1], (float)command.values[2], (float)command.values[3], (float)command.values[4], (float)command.values[5]);
+				break;
+				case PropertyCommandKinds::AUTOMATE:
+				command.automator->setScheduledTime(prop.getTime()+time);
+				command.automator->setProperty(&prop);
+				prop.scheduleAutomator(command.automator, true);
+				command.automator = nullptr; //The property has it now.
+				break;
+				case PropertyCommandKinds::CANCEL_AUTOMATORS:
+				prop.cancelAutomators(time);
+				break;
+			}
+		}
+		catch(ErrorException &e) {
+			//The caller is long gone, so all we can do is say so. Logging allocates, so the background thread does it.
+			dropped_property_commands++;
+			last_dropped_property_slot = command.slot;
+			strncpy(last_dropped_property_message, e.message.c_str(), sizeof(last_dropped_property_message)-1);
+			has_dropped_property_commands = true;
+			if(command.automator) retire(command.automator);
+		}
+	}
+}
+
+void Server::logDroppedPropertyCommands() {
+	if(has_dropped_property_commands.exchange(false) == false) return;
+	int count, slot;
+	char message[sizeof(last_dropped_property_message)];
+	{
+		LOCK(*this);
+		count = dropped_property_commands;
+		slot = last_dropped_property_slot;
+		memcpy(message, last_dropped_property_message, sizeof(message));
+		dropped_property_commands = 0;
+	}
+	if(count == 0) return;
+	logInfo("Server: dropped %i queued property commands. The last was for slot %i: %s", count, slot, message);
+}
+
+void Server::buryObject(ExternalObject* obj) {
+	obj->graveyard_next = graveyard.load(std::memory_order_relaxed);
+	while(graveyard.compare_exchange_weak(obj->graveyard_next, obj, std::memory_order_release, std::memory_order_relaxed) == false);
+}
+
+void Server::emptyGraveyard() {
+	auto newest = graveyard.exchange(nullptr, std::memory_order_acquire);
+	if(newest == nullptr) return;
+	//Destroy them in the order they died.
+	ExternalObject* oldest = nullptr;
+	while(newest) {
+		auto next = newest->graveyard_next;
+		newest->graveyard_next = oldest;
+		oldest = newest;
+		newest = next;
+	}
+	//Everything in the graveyard holds a reference to us, so we're alive here, but the last one might take us with it.
+	//Hold on until we're done; if letting go destroys us, ~Server notices it's on this thread.
+	auto self = shared_from_this();
+	{
+		LOCK(*this);
+		while(oldest) {
+			auto next = oldest->graveyard_next;
+			//Anything this lets go of is destroyed here too, since we aren't rendering.
+			destroyExternalObject(this, oldest);
+			oldest = next;
+		}
+	}
+}
+
+void Server::retire(Retirable* obj) {
+	obj->retired_next = retired.load(std::memory_order_relaxed);
+	while(retired.compare_exchange_weak(obj->retired_next, obj, std::memory_order_release, std::memory_order_relaxed) == false);
+}
+
+void Server::freeRetired() {
+	auto obj = retired.exchange(nullptr, std::memory_order_acquire);
+	while(obj) {
+		auto next = obj->retired_next;
+		delete obj;
+		obj = next;
+	}
+}
+
 double Server::getCurrentTime() {
 	return time;
 }
 
 void Server::scheduleCall(double when, std::function<void(void)> func) {
-	scheduled_callbacks.insert(std::make_pair(getCurrentTime()+when, func));
+	//Callbacks run at the end of getBlock, once the time has reached theirs.
+	//If the block count is off by rounding, getBlock catches it and waits another block.
+	double blocks = ceil(when*sr/block_size-1e-6);
+	blocks = std::min(std::max(blocks, 1.0), 1e15);
+	ScheduledCallback c;
+	c.time = getCurrentTime()+when;
+	c.sequence = scheduled_callback_count++;
+	c.callback = std::move(func);
+	uint64_t due = tick_count+(uint64_t)blocks;
+	//If there's no room left, this goes in the wheel after all, and might allocate.
+	if(isRenderingThread() && deferred_callbacks.size() < deferred_callbacks.capacity()) {
+		deferred_callbacks.emplace_back(due, std::move(c));
+		has_deferred_callbacks = true;
+	}
+	else addScheduledCallback(due, std::move(c));
+}
+
+void Server::addScheduledCallback(uint64_t due, ScheduledCallback &&callback) {
+	scheduled_callbacks.schedule(due, std::move(callback));
+	//Everything could come due in the same block, including anything deferred.
+	size_t needed = scheduled_callbacks.size()+due_callbacks.size()+deferred_callbacks.capacity();
+	if(due_callbacks.capacity() < needed) due_callbacks.reserve(std::max(needed, 2*due_callbacks.capacity()));
+}
+
+void Server::scheduleDeferredCallbacks() {
+	if(has_deferred_callbacks.exchange(false) == false) return;
+	LOCK(*this);
+	for(auto &i: deferred_callbacks) addScheduledCallback(i.first, std::move(i.second));
+	deferred_callbacks.clear();
 }
 
 //begin public API
@@ -349,6 +705,70 @@ Lav_PUBLIC_FUNCTION LavError Lav_serverGetThreads(LavHandle serverHandle, int* d
 	PUB_END
 }
 
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetSchedulingPolicy(LavHandle serverHandle, int policy, int priority) {
+	PUB_BEGIN
+	if(policy < Lav_SCHEDULING_POLICY_NORMAL || policy > Lav_SCHEDULING_POLICY_ROUND_ROBIN) ERROR(Lav_ERROR_RANGE, "Unknown scheduling policy.");
+	//This is the range Linux guarantees for realtime policies.
+	if(policy != Lav_SCHEDULING_POLICY_NORMAL && (priority < 1 || priority > 99)) ERROR(Lav_ERROR_RANGE, "Realtime priorities must be from 1 to 99.");
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setSchedulingPolicy(policy, priority);
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetCpuAffinity(LavHandle serverHandle, int cpuCount, int* cpus) {
+	PUB_BEGIN
+	if(cpuCount < 0) ERROR(Lav_ERROR_RANGE, "CPU count must not be negative.");
+	if(cpuCount > 0 && cpus == nullptr) ERROR(Lav_ERROR_NULL_POINTER, "Need CPUs.");
+	for(int i = 0; i < cpuCount; i++) {
+		if(cpus[i] < 0) ERROR(Lav_ERROR_RANGE, "CPU indices must not be negative.");
+	}
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setCpuAffinity(std::vector<int>(cpus, cpus+cpuCount));
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetFlushDenormals(LavHandle serverHandle, int flushDenormals) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setFlushDenormals(flushDenormals != 0);
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetLockMemory(LavHandle serverHandle, int lockMemory) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setLockMemory(lockMemory != 0);
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverGetCriticalPathCost(LavHandle serverHandle, double* destination) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	*destination = s->getCriticalPathCost();
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetBufferPooling(LavHandle serverHandle, int pooling) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setBufferPooling(pooling != 0);
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetQueuePropertyWrites(LavHandle serverHandle, int queue) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setQueuePropertyWrites(queue != 0);
+	PUB_END
+}
+
 Lav_PUBLIC_FUNCTION LavError Lav_serverCallIn(LavHandle serverHandle, double when, int inAudioThread, LavTimeCallback cb, void* userdata) {
 	PUB_BEGIN
 	auto s = incomingObject<Server>(serverHandle);
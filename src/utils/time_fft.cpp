@@ -0,0 +1,56 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Times a forward and inverse real fft for every backend at sizes from 64 to 65536, and prints the throughput.
+The usual estimate of 2.5 n log2(n) flops per real transform is used for the mflops column, so backends can be compared across sizes.
+This uses internal classes directly, so it is only built where the library exports them.*/
+#include "time_helper.hpp"
+#include <libaudioverse/libaudioverse.h>
+#include <libaudioverse/private/fft.hpp>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <memory>
+
+//Roughly this many samples get transformed per size and backend, so every size takes about as long.
+#define SAMPLES_PER_SIZE 50000000
+
+using namespace libaudioverse_implementation;
+
+void timePlan(FftPlan* plan) {
+	int size = plan->getSize();
+	std::vector<float> input(size), output(size), real(plan->getBinCount()), imag(plan->getBinCount()), scratch(plan->getScratchSize());
+	for(auto &i: input) i = rand()/(float)RAND_MAX-0.5f;
+	int times = SAMPLES_PER_SIZE/size;
+	float seconds = timeit([&] () {
+		plan->forward(&input[0], &real[0], &imag[0], &scratch[0]);
+		plan->inverse(&real[0], &imag[0], &output[0], &scratch[0]);
+	}, times)/times/2;
+	double mflops = 2.5*size*log2((double)size)/seconds/1e6;
+	printf("%i\t%s\t%f\t%.0f\n", size, plan->getBackendName(), seconds*1e6, mflops);
+}
+
+int main(int argc, char** args) {
+	if(Lav_initialize() != Lav_ERROR_NONE) {
+		printf("Couldn't initialize Libaudioverse.\n");
+		return 1;
+	}
+	printf("size\tbackend\tus per transform\tmflops\n");
+	for(int size = 64; size <= 65536; size *= 2) {
+		//Bypass the cache so that we always get every backend.
+		std::unique_ptr<FftPlan> kiss(createKissFftPlan(size));
+		timePlan(kiss.get());
+		#if defined(LIBAUDIOVERSE_USE_SSE2)
+		std::unique_ptr<FftPlan> simd(createSimdFftPlan(size));
+		timePlan(simd.get());
+		#endif
+	}
+	Lav_shutdown();
+	return 0;
+}
@@ -0,0 +1,54 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Times FftConvolver against PartitionedConvolver for responses from 0.1 to 10 seconds, and prints how long a block takes with each.
+This uses internal classes directly, so it is only built where the library exports them.*/
+#include "time_helper.hpp"
+#include <libaudioverse/libaudioverse.h>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+
+#define BLOCK_SIZE 1024
+#define SR 44100
+#define NUM_TIMES 100
+
+using namespace libaudioverse_implementation;
+
+int main(int argc, char** args) {
+	if(Lav_initialize() != Lav_ERROR_NONE) {
+		printf("Couldn't initialize Libaudioverse.\n");
+		return 1;
+	}
+	printf("Using %s kernels, block size %i at %i HZ\n", getKernelInstructionSet(), BLOCK_SIZE, SR);
+	printf("seconds\tfft ms\tpartitioned ms\tspeedup\n");
+	std::vector<float> input(BLOCK_SIZE), output(BLOCK_SIZE);
+	for(auto &i: input) i = rand()/(float)RAND_MAX-0.5f;
+	for(double seconds: {0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 6.0, 8.0, 10.0}) {
+		int length = (int)(seconds*SR);
+		std::vector<float> response(length);
+		//Decaying noise, like a room.
+		for(int i = 0; i < length; i++) response[i] = (rand()/(float)RAND_MAX-0.5f)*(1.0f-i/(float)length);
+		FftConvolver fft(BLOCK_SIZE);
+		PartitionedConvolver partitioned(BLOCK_SIZE);
+		fft.setResponse(length, &response[0]);
+		partitioned.setResponse(length, &response[0]);
+		float fftTime = timeit([&] () {
+			fft.convolve(&input[0], &output[0]);
+		}, NUM_TIMES)/NUM_TIMES*1000;
+		float partitionedTime = timeit([&] () {
+			partitioned.convolve(&input[0], &output[0]);
+		}, NUM_TIMES)/NUM_TIMES*1000;
+		printf("%.2f\t%f\t%f\t%.1fx\n", seconds, fftTime, partitionedTime, fftTime/partitionedTime);
+	}
+	Lav_shutdown();
+	return 0;
+}
@@ -0,0 +1,66 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Resolves handles from several threads at once and prints how many resolutions per second we manage, to check that handle lookup doesn't serialize callers.*/
+#include <libaudioverse/libaudioverse.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <atomic>
+
+#define NUM_NODES 64
+#define NUM_TIMES 1000000
+
+#define ERRCHECK(x) do {\
+if((x) != Lav_ERROR_NONE) {\
+	printf(#x " errored: %i", (x));\
+	Lav_shutdown();\
+	return 1;\
+}\
+} while(0)\
+
+int main(int argc, char** args) {
+	int threads = std::thread::hardware_concurrency();
+	if(argc == 2) sscanf(args[1], "%i", &threads);
+	if(threads < 1) {
+		printf("Usage: %s [thread_count]\n", args[0]);
+		return 1;
+	}
+	ERRCHECK(Lav_initialize());
+	LavHandle server;
+	ERRCHECK(Lav_createServer(44100, 1024, &server));
+	std::vector<LavHandle> nodes(NUM_NODES, 0);
+	for(auto &i: nodes) ERRCHECK(Lav_createSineNode(server, &i));
+	std::atomic<int> failures{0};
+	//Each thread walks the nodes from a different place, so that some share handles and some don't.
+	auto worker = [&] (int offset) {
+		int type;
+		for(int i = 0; i < NUM_TIMES; i++) {
+			LavHandle h = nodes[(i+offset)%NUM_NODES];
+			if(Lav_handleGetType(h, &type) != Lav_ERROR_NONE) failures++;
+			if(i%16 == 0) {
+				if(Lav_handleIncRef(h) != Lav_ERROR_NONE || Lav_handleDecRef(h) != Lav_ERROR_NONE) failures++;
+			}
+		}
+	};
+	printf("Resolving handles %i times on each of %i threads\n", NUM_TIMES, threads);
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> running;
+	for(int i = 0; i < threads; i++) running.emplace_back(worker, i*(NUM_NODES/threads+1));
+	for(auto &i: running) i.join();
+	double t = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+	for(auto i: nodes) ERRCHECK(Lav_handleDecRef(i));
+	ERRCHECK(Lav_handleDecRef(server));
+	Lav_shutdown();
+	if(failures) printf("%i calls failed\n", failures.load());
+	printf("Took %f seconds\n", t);
+	printf("%f million resolutions per second\n", (double)NUM_TIMES*threads/t/1e6);
+	return 0;
+}
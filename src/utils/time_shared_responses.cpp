@@ -0,0 +1,62 @@
+/* Copyright 2016 Libaudioverse Developers. See the COPYRIGHT
+file at the top-level directory of this distribution.
+
+Licensed under the mozilla Public License, version 2.0 <LICENSE.MPL2 or
+https://www.mozilla.org/en-US/MPL/2.0/> or the Gbnu General Public License, V3 or later
+<LICENSE.GPL3 or http://www.gnu.org/licenses/>, at your option. All files in the project
+carrying such notice may not be copied, modified, or distributed except according to those terms. */
+
+/**Gives many fft convolver nodes the same response, then prints how long setting it took and how much memory the response spectra use.
+The first node pays for the ffts and everyone after should share them, so later nodes should be much faster and the memory shouldn't grow.
+This uses internal functions directly, so it is only built where the library exports them.*/
+#include "time_helper.hpp"
+#include <libaudioverse/libaudioverse.h>
+#include <libaudioverse/private/response_spectra.hpp>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+
+#define NUM_NODES 500
+#define SR 44100
+#define BLOCK_SIZE 1024
+#define RESPONSE_SECONDS 2
+
+#define ERRCHECK(x) do {\
+if((x) != Lav_ERROR_NONE) {\
+	printf(#x " errored: %i", (x));\
+	Lav_shutdown();\
+	return 1;\
+}\
+} while(0)\
+
+using namespace libaudioverse_implementation;
+
+int main(int argc, char** args) {
+	ERRCHECK(Lav_initialize());
+	LavHandle server;
+	ERRCHECK(Lav_createServer(SR, BLOCK_SIZE, &server));
+	int length = RESPONSE_SECONDS*SR;
+	std::vector<float> response(length);
+	//Decaying noise, like a room.
+	for(int i = 0; i < length; i++) response[i] = (rand()/(float)RAND_MAX-0.5f)*(1.0f-i/(float)length);
+	std::vector<LavHandle> nodes(NUM_NODES, 0);
+	for(auto &i: nodes) ERRCHECK(Lav_createFftConvolverNode(server, 1, &i));
+	float first = timeit([&] () {
+		Lav_fftConvolverNodeSetResponse(nodes[0], 0, length, &response[0]);
+	});
+	int count;
+	long long bytes;
+	getResponseSpectrumCacheUsage(count, bytes);
+	printf("After 1 node: %i spectra, %.2f MB\n", count, bytes/1048576.0);
+	float rest = timeit([&] () {
+		for(int i = 1; i < NUM_NODES; i++) Lav_fftConvolverNodeSetResponse(nodes[i], 0, length, &response[0]);
+	});
+	getResponseSpectrumCacheUsage(count, bytes);
+	printf("After %i nodes: %i spectra, %.2f MB\n", NUM_NODES, count, bytes/1048576.0);
+	printf("Without sharing, that would be %.2f MB.\n", bytes*(double)NUM_NODES/1048576.0);
+	printf("Setting the response on the first node took %f ms; the rest took %f ms each.\n", first*1000, rest*1000/(NUM_NODES-1));
+	for(auto i: nodes) ERRCHECK(Lav_handleDecRef(i));
+	ERRCHECK(Lav_handleDecRef(server));
+	Lav_shutdown();
+	return 0;
+}